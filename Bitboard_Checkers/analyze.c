@@ -0,0 +1,354 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+#include "notation.h"
+#include "search.h"
+#include "stats.h"
+#include "tt.h"
+
+/*
+ * Input: a position file as read by LoadPositions (notation.h).
+ * Output: one line per position, in input order:
+ *   <n> bestmove <move> score <s> depth <d> nodes <n> pv <moves...>
+ *   <n> bestmove none                  (no legal moves)
+ *   <n> error <reason>                 (unreadable or illegal position)
+ * with scores and moves as in the engine protocol.
+ */
+
+#define DEFAULT_DEPTH 12
+
+// Positions handed out together; a slow one holds up at most this many
+#define BLOCK_POSITIONS 4
+
+#define LINE_SIZE 4096
+
+// One worker's queue of blocks; the owner and thieves both take from the head
+typedef struct {
+    pthread_mutex_t lock;
+    int* blocks;
+    int head, tail;
+} WorkQueue;
+
+static PositionEntry* positions = NULL;
+static int position_count = 0;
+static int first_position = 0;          // Positions before this were analysed by an earlier run
+
+static SearchLimits limits;
+static int threads;
+static WorkQueue* queues;
+
+// Finished output lines waiting for their turn (NULL until analysed)
+static char** results;
+static int next_write;
+static pthread_mutex_t results_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t results_ready = PTHREAD_COND_INITIALIZER;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Finds where an earlier run stopped
+ * Output is written in input order, so the number of complete lines is the
+ * number of positions done; a line cut off by an interrupted run is removed.
+ * @param path Output file of the earlier run
+ * @return Positions already analysed, or -1 if the file cannot be repaired
+ */
+static int CountFinished(const char* path) {
+    FILE* file = fopen(path, "r+");
+    if (file == NULL) return 0;
+
+    int lines = 0;
+    long complete = 0;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (c == '\n') {
+            lines++;
+            complete = ftell(file);
+        }
+    }
+    int ok = fflush(file) == 0 && ftruncate(fileno(file), complete) == 0;
+    fclose(file);
+    return ok ? lines : -1;
+}
+
+// Formats a score like the engine protocol: centi-men, or "win P"/"loss P" in plies
+static int FormatScore(char* text, size_t size, int score) {
+    if (score >= WIN_BOUND) return snprintf(text, size, "win %d", WIN_SCORE - score);
+    if (score <= -WIN_BOUND) return snprintf(text, size, "loss %d", WIN_SCORE + score);
+    return snprintf(text, size, "%d", score);
+}
+
+// Analyses one position into its output line (heap allocated)
+static char* Analyse(Searcher* searcher, int index) {
+    const PositionEntry* position = &positions[index];
+    char line[LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "%d ", index + 1);
+
+    SearchResult result;
+    if (position->error != NULL) {
+        snprintf(line + length, sizeof(line) - length, "error %s", position->error);
+    } else if (!SearcherBestMove(searcher, &position->game, &limits, &result)) {
+        snprintf(line + length, sizeof(line) - length, "bestmove none");
+    } else {
+        char move[MOVE_TEXT_SIZE];
+        FormatMove(&position->game, &result.best_move, move);
+        length += snprintf(line + length, sizeof(line) - length, "bestmove %s score ", move);
+        length += FormatScore(line + length, sizeof(line) - length, result.score);
+        length += snprintf(line + length, sizeof(line) - length, " depth %d nodes %llu pv",
+                           result.depth, result.nodes);
+
+        GameState game = position->game;
+        for (int i = 0; i < result.pv_length && length < (int)sizeof(line) - MOVE_TEXT_SIZE; i++) {
+            FormatMove(&game, &result.pv[i], move);
+            length += snprintf(line + length, sizeof(line) - length, " %s", move);
+            DoMove(&game, &result.pv[i]);
+        }
+    }
+    return strdup(line);
+}
+
+// Takes the next block: the worker's own first, otherwise the oldest block of
+// the fullest queue (the writer is most likely waiting for it). Returns -1 when none are left.
+static int TakeBlock(int self) {
+    WorkQueue* own = &queues[self];
+    pthread_mutex_lock(&own->lock);
+    int block = own->head < own->tail ? own->blocks[own->head++] : -1;
+    pthread_mutex_unlock(&own->lock);
+
+    while (block < 0) {
+        int victim = -1, most = 0;
+        for (int i = 0; i < threads; i++) {
+            int left = __atomic_load_n(&queues[i].tail, __ATOMIC_RELAXED) -
+                       __atomic_load_n(&queues[i].head, __ATOMIC_RELAXED);
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim < 0) return -1;
+
+        pthread_mutex_lock(&queues[victim].lock);
+        if (queues[victim].head < queues[victim].tail) block = queues[victim].blocks[queues[victim].head++];
+        pthread_mutex_unlock(&queues[victim].lock);
+    }
+    return block;
+}
+
+// Worker: analyses blocks until every queue is empty
+static void* Worker(void* arg) {
+    int self = (int)(size_t)arg;
+    Searcher* searcher = SearcherCreate(1);
+    if (searcher == NULL) {
+        printf("Error: Could not allocate worker state!\n");
+        exit(1);
+    }
+
+    int block;
+    while ((block = TakeBlock(self)) >= 0) {
+        int start = first_position + block * BLOCK_POSITIONS;
+        int end = start + BLOCK_POSITIONS < position_count ? start + BLOCK_POSITIONS : position_count;
+        for (int i = start; i < end; i++) {
+            char* line = Analyse(searcher, i);
+            if (line == NULL) {
+                printf("Error: Out of memory!\n");
+                exit(1);
+            }
+            pthread_mutex_lock(&results_lock);
+            results[i] = line;
+            if (i == next_write) pthread_cond_signal(&results_ready);
+            pthread_mutex_unlock(&results_lock);
+        }
+    }
+
+    SearcherFree(searcher);
+    return NULL;
+}
+
+// Deals the blocks out round-robin so every worker starts near the front of the file
+static int CreateQueues(void) {
+    int blocks = (position_count - first_position + BLOCK_POSITIONS - 1) / BLOCK_POSITIONS;
+    queues = calloc(threads, sizeof(WorkQueue));
+    if (queues == NULL) return 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].blocks = malloc((blocks / threads + 1) * sizeof(int));
+        if (queues[i].blocks == NULL) return 0;
+    }
+    for (int block = 0; block < blocks; block++) {
+        WorkQueue* queue = &queues[block % threads];
+        queue->blocks[queue->tail++] = block;
+    }
+    return 1;
+}
+
+static void PrintUsage(const char* program) {
+    printf("Usage: %s <positions file> --output FILE [options]\n", program);
+    printf("  --output FILE     Result lines, one per position in input order\n");
+    printf("  --depth N         Search every position to depth N (default %d)\n", DEFAULT_DEPTH);
+    printf("  --nodes N         Stop each search after about N nodes instead\n");
+    printf("  --threads N       Worker threads (default: all cores)\n");
+    printf("  --hash MB         Transposition table size (default %d)\n", TT_DEFAULT_MB);
+    printf("  --resume          Continue an interrupted run that wrote FILE\n");
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    const char* input = NULL;
+    const char* output = NULL;
+    int hash_mb = TT_DEFAULT_MB;
+    int resume = 0;
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    limits.max_depth = DEFAULT_DEPTH;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--output") == 0 && has_value) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && has_value) {
+            limits.max_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nodes") == 0 && has_value) {
+            limits.max_nodes = strtoull(argv[++i], NULL, 10);
+            limits.max_depth = 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hash") == 0 && has_value) {
+            hash_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = 1;
+        } else if (argv[i][0] != '-' && input == NULL) {
+            input = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (input == NULL || output == NULL || threads <= 0 || hash_mb <= 0 ||
+        (limits.max_depth <= 0 && limits.max_nodes == 0)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (LoadPositions(input, &positions, &position_count) != FILE_OK) {
+        printf("Error: Could not read positions from '%s'!\n", input);
+        return 1;
+    }
+    if (resume) {
+        first_position = CountFinished(output);
+        if (first_position < 0) {
+            printf("Error: Could not resume from '%s'!\n", output);
+            return 1;
+        }
+        if (first_position > position_count) first_position = position_count;
+    }
+    if (!TTInit(hash_mb)) {
+        printf("Error: Could not allocate %d MB for the hash table!\n", hash_mb);
+        return 1;
+    }
+
+    FILE* file = fopen(output, resume ? "a" : "w");
+    if (file == NULL) {
+        printf("Error: Could not open '%s' for writing!\n", output);
+        return 1;
+    }
+
+    results = calloc(position_count + 1, sizeof(char*));
+    pthread_t* workers = malloc(threads * sizeof(pthread_t));
+    if (results == NULL || workers == NULL || !CreateQueues()) {
+        printf("Error: Could not allocate worker state!\n");
+        return 1;
+    }
+
+    printf("Analysis: %d positions", position_count);
+    if (first_position > 0) printf(" (%d done earlier)", first_position);
+    if (limits.max_nodes > 0) {
+        printf(", %llu nodes each", limits.max_nodes);
+    } else {
+        printf(", depth %d", limits.max_depth);
+    }
+    printf(", %d threads\n", threads);
+
+    double start = Now();
+    next_write = first_position;
+    // Workers steal from every queue, so the queues of threads that could not
+    // be started are still emptied by the others
+    int started = 0;
+    while (started < threads && pthread_create(&workers[started], NULL, Worker, (void*)(size_t)started) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        printf("Error: Could not start any worker thread!\n");
+        return 1;
+    }
+    if (started < threads) printf("Warning: Only %d of %d worker threads could be started\n", started, threads);
+
+    // Writes finished lines in input order as they become available; each
+    // flush is a point a later --resume can continue from
+    int write_failed = 0;
+    double last_report = 0;
+    pthread_mutex_lock(&results_lock);
+    while (next_write < position_count) {
+        if (results[next_write] == NULL) {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += 100000000;
+            if (until.tv_nsec >= 1000000000) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&results_ready, &results_lock, &until);
+        }
+
+        int written = 0;
+        while (next_write < position_count && results[next_write] != NULL) {
+            char* line = results[next_write];
+            results[next_write++] = NULL;
+            pthread_mutex_unlock(&results_lock);
+            if (fprintf(file, "%s\n", line) < 0) write_failed = 1;
+            free(line);
+            written++;
+            pthread_mutex_lock(&results_lock);
+        }
+        if (written > 0 && fflush(file) != 0) write_failed = 1;
+
+        double now = Now();
+        if (now - last_report >= 0.5) {
+            int done = next_write - first_position;
+            printf("\r%d/%d positions (%.1f positions/sec)", next_write, position_count,
+                   now > start ? done / (now - start) : 0.0);
+            fflush(stdout);
+            last_report = now;
+        }
+    }
+    pthread_mutex_unlock(&results_lock);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    if (fclose(file) != 0) write_failed = 1;
+    double elapsed = Now() - start;
+    printf("\r%d/%d positions analysed in %.2fs%30s\n", position_count - first_position,
+           position_count - first_position, elapsed, "");
+
+    if (write_failed) {
+        printf("Error: Writing '%s' failed!\n", output);
+        return 1;
+    }
+    printf("Results written to '%s'\n", output);
+    if (StatsEnabled()) {
+        printf("\n");
+        StatsWriteReport(stdout);
+    }
+    return 0;
+}
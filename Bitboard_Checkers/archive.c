@@ -0,0 +1,452 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "archive.h"
+#include "zobrist.h"
+
+// Stdio buffer for streaming writes
+#define ARCHIVE_BUFFER_SIZE (1 << 20)
+
+// Bytes a record with ply_count moves takes on disk
+static unsigned long long RecordSize(unsigned int ply_count) {
+    return sizeof(ArchiveRecordHeader) + ((2ULL * ply_count + 7) & ~7ULL);
+}
+
+// Name of the index file belonging to an archive
+static void IndexPath(const char* path, char* index_path, int size) {
+    snprintf(index_path, size, "%s.idx", path);
+}
+
+// Starts a record at the given position
+void RecordStart(GameRecord* record, const GameState* game) {
+    memset(&record->start, 0, sizeof(record->start));
+    PackState(game, &record->start);
+    record->ply_count = 0;
+    record->result = RESULT_NONE;
+}
+
+// Appends a played move; returns 0 if the record is full
+int RecordAddMove(GameRecord* record, const Move* move) {
+    if (record->ply_count >= RECORD_MAX_PLIES) return 0;
+    record->moves[record->ply_count++] = EncodeMove(move);
+    return 1;
+}
+
+/**
+ * Rebuilds the position after the first plies moves of a record
+ * @param record Game to replay
+ * @param plies Number of moves to play (clamped to the record's length)
+ * @param game Output position
+ * @return Number of moves played (less than asked if a code does not decode)
+ */
+int RecordReplay(const GameRecord* record, int plies, GameState* game) {
+    UnpackState(&record->start, game);
+    game->hash = ComputeHash(game);
+
+    if (plies > record->ply_count) plies = record->ply_count;
+    int played = 0;
+    while (played < plies) {
+        MoveList list;
+        GenerateMoves(game, &list);
+        const Move* move = FindEncodedMove(&list, record->moves[played]);
+        if (move == NULL) break;
+        DoMove(game, move);
+        played++;
+    }
+    game->game_over = played == record->ply_count && record->result != RESULT_NONE;
+    return played;
+}
+
+/**
+ * Replays a whole record into a move history (for undo and the draw rules)
+ * @param record Game to replay
+ * @param history Output: history ending at the record's last decodable move
+ * @return Number of moves played
+ */
+int RecordHistory(const GameRecord* record, GameHistory* history) {
+    GameState game;
+    UnpackState(&record->start, &game);
+    HistoryStart(history, &game);
+
+    int played = 0;
+    while (played < record->ply_count) {
+        MoveList list;
+        GenerateMoves(&history->position, &list);
+        const Move* move = FindEncodedMove(&list, record->moves[played]);
+        if (move == NULL) break;
+        HistoryAddMove(history, move);
+        played++;
+    }
+    return played;
+}
+
+// Writes one record; returns its size in bytes, 0 on error
+static unsigned long long WriteRecord(FILE* file, const GameRecord* record) {
+    static const unsigned char padding[8] = { 0 };
+    ArchiveRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.start = record->start;
+    header.ply_count = (unsigned int)record->ply_count;
+    header.result = record->result;
+
+    unsigned long long size = RecordSize(header.ply_count);
+    size_t move_bytes = 2 * (size_t)header.ply_count;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(record->moves, 1, move_bytes, file) != move_bytes ||
+        fwrite(padding, 1, size - sizeof(header) - move_bytes, file) != size - sizeof(header) - move_bytes) {
+        return 0;
+    }
+    return size;
+}
+
+// Writes a file header with the given magic
+static int WriteFileHeader(FILE* file, unsigned int magic) {
+    ArchiveFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = magic;
+    header.version = ARCHIVE_VERSION;
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+// Reads and checks a file header; returns 1 if it has the given magic and version
+static int ReadFileHeader(FILE* file, unsigned int magic) {
+    ArchiveFileHeader header;
+    return fread(&header, sizeof(header), 1, file) == 1 &&
+           header.magic == magic && header.version == ARCHIVE_VERSION;
+}
+
+// Size of an open file in bytes
+static long long FileSize(FILE* file) {
+    struct stat info;
+    return fstat(fileno(file), &info) == 0 ? (long long)info.st_size : -1;
+}
+
+/**
+ * Regenerates an archive's index by walking its records
+ * A record cut short by an interrupted append is removed from the archive.
+ * @param path Archive file
+ * @return FILE_OK, or why the archive could not be read or the index written
+ */
+FileStatus ArchiveRebuildIndex(const char* path) {
+    char index_path[1024];
+    IndexPath(path, index_path, sizeof(index_path));
+
+    FILE* data = fopen(path, "rb");
+    if (data == NULL) return FILE_ERROR_OPEN;
+    long long data_size = FileSize(data);
+    if (!ReadFileHeader(data, ARCHIVE_MAGIC)) {
+        fclose(data);
+        return FILE_ERROR_FORMAT;
+    }
+
+    FILE* index = fopen(index_path, "wb");
+    if (index == NULL) {
+        fclose(data);
+        return FILE_ERROR_OPEN;
+    }
+    WriteFileHeader(index, ARCHIVE_INDEX_MAGIC);
+
+    unsigned long long offset = sizeof(ArchiveFileHeader);
+    ArchiveRecordHeader header;
+    while (fseek(data, (long)offset, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, data) == 1) {
+        unsigned long long size = RecordSize(header.ply_count);
+        if (header.ply_count > RECORD_MAX_PLIES || offset + size > (unsigned long long)data_size) break;
+        fwrite(&offset, sizeof(offset), 1, index);
+        offset += size;
+    }
+    fclose(data);
+
+    int ok = !ferror(index);
+    if (fclose(index) != 0) ok = 0;
+    if (ok && offset < (unsigned long long)data_size && truncate(path, (off_t)offset) != 0) ok = 0;
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+// Checks that the index lists exactly the records in the archive
+static int IndexIsCurrent(FILE* data, FILE* index) {
+    long long data_size = FileSize(data);
+    long long index_size = FileSize(index);
+    if (index_size < (long long)sizeof(ArchiveFileHeader) || !ReadFileHeader(index, ARCHIVE_INDEX_MAGIC)) {
+        return 0;
+    }
+
+    unsigned long long count = (index_size - sizeof(ArchiveFileHeader)) / sizeof(unsigned long long);
+    if (count == 0) return data_size == (long long)sizeof(ArchiveFileHeader);
+
+    unsigned long long last;
+    ArchiveRecordHeader header;
+    if (fseek(index, (long)(sizeof(ArchiveFileHeader) + (count - 1) * sizeof(last)), SEEK_SET) != 0 ||
+        fread(&last, sizeof(last), 1, index) != 1 ||
+        fseek(data, (long)last, SEEK_SET) != 0 ||
+        fread(&header, sizeof(header), 1, data) != 1) {
+        return 0;
+    }
+    return last + RecordSize(header.ply_count) == (unsigned long long)data_size;
+}
+
+/**
+ * Opens an archive for appending, creating it if needed
+ * A stale index (e.g. after a crash between the two writes of an append)
+ * is rebuilt first, so numbers handed out always match record positions.
+ * @param writer Writer to initialize
+ * @param path Archive file; the index goes to "<path>.idx"
+ * @return FILE_OK, or why the archive could not be opened
+ */
+FileStatus ArchiveWriterOpen(ArchiveWriter* writer, const char* path) {
+    char index_path[1024];
+    IndexPath(path, index_path, sizeof(index_path));
+
+    FILE* data = fopen(path, "rb");
+    if (data != NULL) {
+        FILE* index = fopen(index_path, "rb");
+        int current = index != NULL && IndexIsCurrent(data, index);
+        if (index != NULL) fclose(index);
+        fclose(data);
+        if (!current) {
+            FileStatus status = ArchiveRebuildIndex(path);
+            if (status != FILE_OK) return status;
+        }
+    }
+
+    writer->data = fopen(path, "ab");
+    writer->index = fopen(index_path, "ab");
+    if (writer->data == NULL || writer->index == NULL) {
+        if (writer->data != NULL) fclose(writer->data);
+        if (writer->index != NULL) fclose(writer->index);
+        return FILE_ERROR_OPEN;
+    }
+    setvbuf(writer->data, NULL, _IOFBF, ARCHIVE_BUFFER_SIZE);
+
+    long long data_size = FileSize(writer->data);
+    if (data_size == 0) WriteFileHeader(writer->data, ARCHIVE_MAGIC);
+    if (FileSize(writer->index) == 0) WriteFileHeader(writer->index, ARCHIVE_INDEX_MAGIC);
+
+    writer->offset = data_size > 0 ? (unsigned long long)data_size : sizeof(ArchiveFileHeader);
+    long long index_size = FileSize(writer->index);
+    writer->count = index_size > (long long)sizeof(ArchiveFileHeader) ?
+                    (index_size - sizeof(ArchiveFileHeader)) / sizeof(unsigned long long) : 0;
+    pthread_mutex_init(&writer->lock, NULL);
+    return FILE_OK;
+}
+
+/**
+ * Appends consecutive games to the archive under one lock (thread-safe)
+ * @param writer Open writer
+ * @param records Games to store
+ * @param count Number of games
+ * @param first_number Output: number of the first game in the archive (may be NULL)
+ * @return FILE_OK or FILE_ERROR_WRITE
+ */
+FileStatus ArchiveAppendBatch(ArchiveWriter* writer, const GameRecord* records, int count,
+                              unsigned long long* first_number) {
+    FileStatus status = FILE_OK;
+    pthread_mutex_lock(&writer->lock);
+    if (first_number != NULL) *first_number = writer->count;
+    for (int i = 0; i < count; i++) {
+        unsigned long long offset = writer->offset;
+        unsigned long long size = WriteRecord(writer->data, &records[i]);
+        if (size == 0 || fwrite(&offset, sizeof(offset), 1, writer->index) != 1) {
+            status = FILE_ERROR_WRITE;
+            break;
+        }
+        writer->offset += size;
+        writer->count++;
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return status;
+}
+
+// Appends one game; number receives its position in the archive (may be NULL)
+FileStatus ArchiveAppend(ArchiveWriter* writer, const GameRecord* record, unsigned long long* number) {
+    return ArchiveAppendBatch(writer, record, 1, number);
+}
+
+// Pushes buffered records to the files (data before index)
+FileStatus ArchiveFlush(ArchiveWriter* writer) {
+    pthread_mutex_lock(&writer->lock);
+    int ok = fflush(writer->data) == 0 && fflush(writer->index) == 0;
+    pthread_mutex_unlock(&writer->lock);
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+// Flushes and closes both files
+FileStatus ArchiveWriterClose(ArchiveWriter* writer) {
+    int ok = fclose(writer->data) == 0;
+    if (fclose(writer->index) != 0) ok = 0;
+    pthread_mutex_destroy(&writer->lock);
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+// Maps a whole file read-only; returns NULL for missing or empty files
+static const unsigned char* MapFile(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    *size = info.st_size;
+    return map;
+}
+
+// Walks the mapped records to build offsets in memory
+static int ScanRecords(Archive* archive) {
+    unsigned long long capacity = 1024;
+    archive->scanned_offsets = malloc(capacity * sizeof(unsigned long long));
+    if (archive->scanned_offsets == NULL) return 0;
+
+    unsigned long long offset = sizeof(ArchiveFileHeader);
+    archive->count = 0;
+    while (offset + sizeof(ArchiveRecordHeader) <= archive->data_size) {
+        const ArchiveRecordHeader* header = (const ArchiveRecordHeader*)(archive->data + offset);
+        unsigned long long size = RecordSize(header->ply_count);
+        if (header->ply_count > RECORD_MAX_PLIES || offset + size > archive->data_size) break;
+
+        if (archive->count == capacity) {
+            capacity *= 2;
+            unsigned long long* grown = realloc(archive->scanned_offsets, capacity * sizeof(unsigned long long));
+            if (grown == NULL) return 0;
+            archive->scanned_offsets = grown;
+        }
+        archive->scanned_offsets[archive->count++] = offset;
+        offset += size;
+    }
+    archive->offsets = archive->scanned_offsets;
+    return 1;
+}
+
+/**
+ * Opens an archive for reading
+ * Both files are memory mapped, so looking up game n touches only the
+ * pages holding its index entry and its record. Without a usable index
+ * the records are walked once to find their offsets.
+ * @param archive View to initialize
+ * @param path Archive file
+ * @return FILE_OK, or why the archive could not be read
+ */
+FileStatus ArchiveOpen(Archive* archive, const char* path) {
+    char index_path[1024];
+    IndexPath(path, index_path, sizeof(index_path));
+    memset(archive, 0, sizeof(*archive));
+
+    archive->data = MapFile(path, &archive->data_size);
+    if (archive->data == NULL) return FILE_ERROR_OPEN;
+    const ArchiveFileHeader* header = (const ArchiveFileHeader*)archive->data;
+    if (archive->data_size < sizeof(ArchiveFileHeader) ||
+        header->magic != ARCHIVE_MAGIC || header->version != ARCHIVE_VERSION) {
+        ArchiveClose(archive);
+        return FILE_ERROR_FORMAT;
+    }
+
+    archive->index_map = MapFile(index_path, &archive->index_size);
+    if (archive->index_map != NULL && archive->index_size >= sizeof(ArchiveFileHeader)) {
+        const ArchiveFileHeader* index_header = (const ArchiveFileHeader*)archive->index_map;
+        unsigned long long count = (archive->index_size - sizeof(ArchiveFileHeader)) / sizeof(unsigned long long);
+        const unsigned long long* offsets =
+            (const unsigned long long*)(archive->index_map + sizeof(ArchiveFileHeader));
+
+        // The index is trusted only if its last entry ends exactly at the end of the data
+        unsigned long long end = sizeof(ArchiveFileHeader);
+        if (count > 0 && offsets[count - 1] + sizeof(ArchiveRecordHeader) <= archive->data_size) {
+            const ArchiveRecordHeader* last = (const ArchiveRecordHeader*)(archive->data + offsets[count - 1]);
+            end = offsets[count - 1] + RecordSize(last->ply_count);
+        }
+        if (index_header->magic == ARCHIVE_INDEX_MAGIC && end == archive->data_size) {
+            archive->offsets = offsets;
+            archive->count = count;
+            return FILE_OK;
+        }
+    }
+
+    if (!ScanRecords(archive)) {
+        ArchiveClose(archive);
+        return FILE_ERROR_FORMAT;
+    }
+    return FILE_OK;
+}
+
+// Unmaps an archive opened with ArchiveOpen
+void ArchiveClose(Archive* archive) {
+    if (archive->data != NULL) munmap((void*)archive->data, archive->data_size);
+    if (archive->index_map != NULL) munmap((void*)archive->index_map, archive->index_size);
+    free(archive->scanned_offsets);
+    memset(archive, 0, sizeof(*archive));
+}
+
+/**
+ * Gives direct access to a stored game without copying it
+ * @param archive Open archive
+ * @param number Game number (0-based)
+ * @param moves Output: the game's move codes, ply_count of them
+ * @return The record header, or NULL if number is out of range or the record is damaged
+ */
+const ArchiveRecordHeader* ArchiveGameHeader(const Archive* archive, unsigned long long number,
+                                             const unsigned short** moves) {
+    if (number >= archive->count) return NULL;
+    unsigned long long offset = archive->offsets[number];
+    if (offset + sizeof(ArchiveRecordHeader) > archive->data_size) return NULL;
+
+    const ArchiveRecordHeader* header = (const ArchiveRecordHeader*)(archive->data + offset);
+    if (header->ply_count > RECORD_MAX_PLIES || offset + RecordSize(header->ply_count) > archive->data_size) {
+        return NULL;
+    }
+    *moves = (const unsigned short*)(header + 1);
+    return header;
+}
+
+// Copies a stored game into a record; returns 0 if it does not exist
+int ArchiveGetGame(const Archive* archive, unsigned long long number, GameRecord* record) {
+    const unsigned short* moves;
+    const ArchiveRecordHeader* header = ArchiveGameHeader(archive, number, &moves);
+    if (header == NULL) return 0;
+
+    record->start = header->start;
+    record->ply_count = (int)header->ply_count;
+    record->result = header->result;
+    memcpy(record->moves, moves, 2 * (size_t)header->ply_count);
+    return 1;
+}
+
+// Saves one game (start position and moves) in the binary format
+FileStatus SaveGameBinary(const GameRecord* record, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return FILE_ERROR_OPEN;
+    }
+
+    int ok = WriteFileHeader(file, ARCHIVE_MAGIC) && WriteRecord(file, record) != 0;
+    if (fclose(file) != 0) ok = 0;
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+// Loads the first game of a binary file (record is left untouched on failure)
+FileStatus LoadGameBinary(GameRecord* record, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return FILE_ERROR_OPEN;
+    }
+
+    ArchiveRecordHeader header;
+    unsigned short moves[RECORD_MAX_PLIES];
+    int ok = ReadFileHeader(file, ARCHIVE_MAGIC) &&
+             fread(&header, sizeof(header), 1, file) == 1 &&
+             header.ply_count <= RECORD_MAX_PLIES &&
+             fread(moves, 2, header.ply_count, file) == header.ply_count;
+    fclose(file);
+    if (!ok) {
+        return FILE_ERROR_FORMAT;
+    }
+
+    record->start = header.start;
+    record->ply_count = (int)header.ply_count;
+    record->result = header.result;
+    memcpy(record->moves, moves, 2 * (size_t)header.ply_count);
+    return FILE_OK;
+}
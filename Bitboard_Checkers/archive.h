@@ -0,0 +1,88 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include "board.h"
+#include "board32.h"
+#include "game.h"
+#include "history.h"
+#include "movegen.h"
+
+// Longest game a record can hold (plies)
+#define RECORD_MAX_PLIES 1024
+
+// A game in memory: start position, every move as a 16-bit code, outcome
+typedef struct {
+    CompactState start;
+    unsigned short moves[RECORD_MAX_PLIES];
+    int ply_count;
+    int result;                         // GameResult (RESULT_NONE if unfinished)
+} GameRecord;
+
+// Archive files are a header followed by records; each record is this header,
+// ply_count move codes, then zero padding to a multiple of 8 bytes.
+// Game n starts at offsets[n] of the companion "<archive>.idx" file.
+#define ARCHIVE_MAGIC       0x41474B43U   // "CKGA"
+#define ARCHIVE_INDEX_MAGIC 0x49474B43U   // "CKGI"
+#define ARCHIVE_VERSION     1
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long reserved;
+} ArchiveFileHeader;
+
+typedef struct {
+    CompactState start;
+    unsigned int ply_count;
+    int result;
+} ArchiveRecordHeader;
+
+// Read-only view of an archive (both files memory mapped)
+typedef struct {
+    const unsigned char* data;
+    size_t data_size;
+    const unsigned char* index_map;
+    size_t index_size;
+    const unsigned long long* offsets;
+    unsigned long long* scanned_offsets;  // Built in memory when the index is stale
+    unsigned long long count;
+} Archive;
+
+// Appends records; one writer may be shared by several threads
+typedef struct {
+    FILE* data;
+    FILE* index;
+    unsigned long long offset;          // Where the next record goes
+    unsigned long long count;
+    pthread_mutex_t lock;
+} ArchiveWriter;
+
+// Building and replaying records
+void RecordStart(GameRecord* record, const GameState* game);
+int RecordAddMove(GameRecord* record, const Move* move);
+int RecordReplay(const GameRecord* record, int plies, GameState* game);
+int RecordHistory(const GameRecord* record, GameHistory* history);
+
+// Writing
+FileStatus ArchiveWriterOpen(ArchiveWriter* writer, const char* path);
+FileStatus ArchiveAppend(ArchiveWriter* writer, const GameRecord* record, unsigned long long* number);
+FileStatus ArchiveAppendBatch(ArchiveWriter* writer, const GameRecord* records, int count,
+                              unsigned long long* first_number);
+FileStatus ArchiveFlush(ArchiveWriter* writer);
+FileStatus ArchiveWriterClose(ArchiveWriter* writer);
+FileStatus ArchiveRebuildIndex(const char* path);
+
+// Reading
+FileStatus ArchiveOpen(Archive* archive, const char* path);
+void ArchiveClose(Archive* archive);
+const ArchiveRecordHeader* ArchiveGameHeader(const Archive* archive, unsigned long long number,
+                                             const unsigned short** moves);
+int ArchiveGetGame(const Archive* archive, unsigned long long number, GameRecord* record);
+
+// Single-game binary save files share the archive format
+FileStatus SaveGameBinary(const GameRecord* record, const char* filename);
+FileStatus LoadGameBinary(GameRecord* record, const char* filename);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,24 @@
+#include <stdlib.h>
+#include "arena.h"
+
+/**
+ * Allocates an arena's memory
+ * @param arena Arena to set up (empty, peak zero)
+ * @param size Capacity in bytes
+ * @return 1 on success, 0 if the memory could not be allocated
+ */
+int ArenaInit(Arena* arena, size_t size) {
+    size = (size + 63) & ~(size_t)63;
+    arena->base = aligned_alloc(64, size);
+    arena->size = arena->base != NULL ? size : 0;
+    arena->used = 0;
+    arena->peak = 0;
+    return arena->base != NULL;
+}
+
+// Releases an arena's memory
+void ArenaFree(Arena* arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Alignment of every block (enough for any field the search stores)
+#define ARENA_ALIGN 16
+
+// Fixed-size bump allocator used like a stack: blocks are taken from the top
+// and given back by releasing to an earlier mark. The memory is allocated
+// once, so taking and releasing blocks never calls malloc. peak records the
+// most bytes ever in use, for sizing the arena.
+typedef struct {
+    unsigned char* base;
+    size_t size;
+    size_t used;
+    size_t peak;
+} Arena;
+
+int ArenaInit(Arena* arena, size_t size);
+void ArenaFree(Arena* arena);
+
+// Takes bytes from the top of the arena; returns NULL if they do not fit
+static inline void* ArenaAlloc(Arena* arena, size_t bytes) {
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (start + bytes > arena->size) return NULL;
+    arena->used = start + bytes;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return arena->base + start;
+}
+
+// Cuts the most recent block down to its first bytes
+static inline void ArenaShrink(Arena* arena, void* block, size_t bytes) {
+    arena->used = (size_t)((unsigned char*)block - arena->base) + bytes;
+}
+
+// Current top, to release everything taken after it
+static inline size_t ArenaMark(const Arena* arena) {
+    return arena->used;
+}
+
+static inline void ArenaRelease(Arena* arena, size_t mark) {
+    arena->used = mark;
+}
+
+#endif // ARENA_H
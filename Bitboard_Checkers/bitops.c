@@ -1,38 +1,65 @@
 #include <stdio.h>
 #include "bitops.h"
 
-// Sets a specific bit to 1
-unsigned long long SetBit(unsigned long long value, int position) {
-    if (position < 0 || position >= 64) return value;
-    return value | (1ULL << position);
+int cpu_features = 0;
+
+// Portable parallel bit extract: gathers the bits of value selected by mask
+static unsigned long long ExtractBitsPortable(unsigned long long value, unsigned long long mask) {
+    unsigned long long result = 0ULL;
+    for (unsigned long long bit = 1ULL; mask; bit <<= 1) {
+        if (value & mask & -mask) result |= bit;
+        mask &= mask - 1;
+    }
+    return result;
 }
 
-// Clears a specific bit to 0
-unsigned long long ClearBit(unsigned long long value, int position) {
-    if (position < 0 || position >= 64) return value;
-    return value & ~(1ULL << position);
+// Portable parallel bit deposit: scatters the low bits of value onto mask
+static unsigned long long DepositBitsPortable(unsigned long long value, unsigned long long mask) {
+    unsigned long long result = 0ULL;
+    for (unsigned long long bit = 1ULL; mask; bit <<= 1) {
+        if (value & bit) result |= mask & -mask;
+        mask &= mask - 1;
+    }
+    return result;
 }
 
-// Toggles a specific bit (0->1 or 1->0)
-unsigned long long ToggleBit(unsigned long long value, int position) {
-    if (position < 0 || position >= 64) return value;
-    return value ^ (1ULL << position);
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("bmi2")))
+static unsigned long long ExtractBitsBMI2(unsigned long long value, unsigned long long mask) {
+    return __builtin_ia32_pext_di(value, mask);
 }
 
-// Gets the value of a specific bit
-int GetBit(unsigned long long value, int position) {
-    if (position < 0 || position >= 64) return 0;
-    return (value >> position) & 1ULL;
+__attribute__((target("bmi2")))
+static unsigned long long DepositBitsBMI2(unsigned long long value, unsigned long long mask) {
+    return __builtin_ia32_pdep_di(value, mask);
 }
+#endif
+
+unsigned long long (*ExtractBits)(unsigned long long value, unsigned long long mask) = ExtractBitsPortable;
+unsigned long long (*DepositBits)(unsigned long long value, unsigned long long mask) = DepositBitsPortable;
+
+/**
+ * Detects CPU features and picks the dispatched implementations
+ * Safe to call more than once; until it is called the portable versions are used.
+ * @return Detected CPU_* feature flags
+ */
+int InitBitops(void) {
+    cpu_features = 0;
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")) cpu_features |= CPU_POPCNT;
+    if (__builtin_cpu_supports("bmi2")) cpu_features |= CPU_BMI2;
+    if (__builtin_cpu_supports("avx2")) cpu_features |= CPU_AVX2;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        cpu_features |= CPU_AVX512;
+    }
 
-// Counts the number of 1 bits in a value
-int CountBits(unsigned long long value) {
-    int count = 0;
-    while (value) {
-        count += value & 1ULL;
-        value >>= 1;
+    if (cpu_features & CPU_BMI2) {
+        ExtractBits = ExtractBitsBMI2;
+        DepositBits = DepositBitsBMI2;
     }
-    return count;
+#endif
+    return cpu_features;
 }
 
 // Shifts bits to the left
@@ -1,19 +1,86 @@
 #ifndef BITOPS_H
 #define BITOPS_H
 
+// The single-bit and counting operations are defined here as static inline
+// functions: they run on every hot path, so they must not cost a call.
+// Range checks on position fold away when the position is a constant.
+
 // Basic bit operations
-unsigned long long SetBit(unsigned long long value, int position);
-unsigned long long ClearBit(unsigned long long value, int position);
-unsigned long long ToggleBit(unsigned long long value, int position);
-int GetBit(unsigned long long value, int position);
+static inline unsigned long long SetBit(unsigned long long value, int position) {
+    if (position < 0 || position >= 64) return value;
+    return value | (1ULL << position);
+}
+
+static inline unsigned long long ClearBit(unsigned long long value, int position) {
+    if (position < 0 || position >= 64) return value;
+    return value & ~(1ULL << position);
+}
+
+static inline unsigned long long ToggleBit(unsigned long long value, int position) {
+    if (position < 0 || position >= 64) return value;
+    return value ^ (1ULL << position);
+}
+
+static inline int GetBit(unsigned long long value, int position) {
+    if (position < 0 || position >= 64) return 0;
+    return (value >> position) & 1ULL;
+}
 
 // Counting and finding
-int CountBits(unsigned long long value);
+// Compiles to POPCNT / TZCNT (or BSF) when the target has them (e.g. make NATIVE=1).
+// GCC also turns the SWAR count into POPCNT inside functions built with
+// target("popcnt"), which is how the hottest callers dispatch at run time.
+static inline int CountBits(unsigned long long value) {
+#if defined(__POPCNT__)
+    return __builtin_popcountll(value);
+#else
+    // Portable SWAR count: cheaper than the library call GCC emits without POPCNT
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit (value must not be 0)
+static inline int LowestBit(unsigned long long value) {
+    return __builtin_ctzll(value);
+}
+
+// Removes the lowest set bit and returns its index (value must not be 0)
+static inline int PopLowestBit(unsigned long long* value) {
+    int position = __builtin_ctzll(*value);
+    *value &= *value - 1;
+    return position;
+}
+
+// Loops over the index of every set bit, lowest first:
+//   int pos;
+//   FOR_EACH_BIT(pos, pieces) { ... }
+#define FOR_EACH_BIT(position, bitboard) \
+    for (unsigned long long bits_left_ = (bitboard); \
+         bits_left_ && ((position) = __builtin_ctzll(bits_left_), 1); \
+         bits_left_ &= bits_left_ - 1)
 
 // Shift operations
 unsigned long long ShiftLeft(unsigned long long value, int positions);
 unsigned long long ShiftRight(unsigned long long value, int positions);
 
+// CPU features detected at startup by InitBitops
+#define CPU_POPCNT 0x01
+#define CPU_BMI2   0x02
+#define CPU_AVX2   0x04
+#define CPU_AVX512 0x08     // AVX-512F with VPOPCNTQ
+extern int cpu_features;
+
+// Selects the fastest implementation of the dispatched operations below
+int InitBitops(void);
+
+// Parallel bit extract/deposit: PEXT/PDEP on BMI2 CPUs, a bit loop otherwise.
+// Runtime dispatched, so one binary runs everywhere.
+extern unsigned long long (*ExtractBits)(unsigned long long value, unsigned long long mask);
+extern unsigned long long (*DepositBits)(unsigned long long value, unsigned long long mask);
+
 // Display functions
 void PrintBinary(unsigned long long value);
 void PrintHex(unsigned long long value);
@@ -21,4 +88,4 @@ void PrintHex(unsigned long long value);
 // Testing function
 void TestBitFunctions();
 
-#endif // BITOPS_H
\ No newline at end of file
+#endif // BITOPS_H
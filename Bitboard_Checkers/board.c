@@ -1,9 +1,9 @@
-#include <stdio.h>
 #include "board.h"
 #include "bitops.h"
+#include "zobrist.h"
 
 // Only dark squares are playable in checkers
-const unsigned long long PLAYABLE_SQUARES = 0xAA55AA55AA55AA55ULL;
+const unsigned long long PLAYABLE_SQUARES = 0x55AA55AA55AA55AAULL;
 
 // Initializes a new game with standard checkers starting position
 void InitializeGame(GameState* game) {
@@ -33,63 +33,8 @@ void InitializeGame(GameState* game) {
             game->black_pieces = SetBit(game->black_pieces, pos);
         }
     }
-}
-
-// Displays the game board with a nice visual layout
-void DisplayBoard(GameState* game) {
-    printf("\n");
-    printf("  ╔═══════════════════════════════╗\n");
-    printf("  ║  BITBOARD CHECKERS GAME       ║\n");
-    printf("  ╚═══════════════════════════════╝\n");
-    printf("\n    0   1   2   3   4   5   6   7\n");
-    printf("  ╔═══╦═══╦═══╦═══╦═══╦═══╦═══╦═══╗\n");
-    
-    for (int row = 7; row >= 0; row--) {
-        printf("%d ║", row);
-        
-        for (int col = 0; col < 8; col++) {
-            int pos = row * 8 + col;
-            int is_dark = (row + col) % 2 == 1;
-            
-            // Check what piece is at this position
-            int has_red = GetBit(game->red_pieces, pos);
-            int has_red_king = GetBit(game->red_kings, pos);
-            int has_black = GetBit(game->black_pieces, pos);
-            int has_black_king = GetBit(game->black_kings, pos);
-            
-            if (has_red_king) {
-                printf(" R̂ ");  // Red King
-            } else if (has_red) {
-                printf(" r ");   // Red piece
-            } else if (has_black_king) {
-                printf(" B̂ ");  // Black King
-            } else if (has_black) {
-                printf(" b ");   // Black piece
-            } else if (is_dark) {
-                printf(" · ");   // Empty dark square
-            } else {
-                printf("   ");   // Light square (not playable)
-            }
-            
-            if (col < 7) printf("║");
-        }
-        
-        printf("║ %d\n", row);
-        
-        if (row > 0) {
-            printf("  ╠═══╬═══╬═══╬═══╬═══╬═══╬═══╬═══╣\n");
-        }
-    }
-    
-    printf("  ╚═══╩═══╩═══╩═══╩═══╩═══╩═══╩═══╝\n");
-    printf("    0   1   2   3   4   5   6   7\n\n");
     
-    // Display legend
-    printf("  Legend: r=Red  R̂=Red King  b=Black  B̂=Black King  ·=Empty\n");
-    printf("  Current Player: %s\n", game->current_player == 0 ? "RED" : "BLACK");
-    printf("  Red Pieces: %d  Black Pieces: %d\n", 
-           CountBits(game->red_pieces | game->red_kings),
-           CountBits(game->black_pieces | game->black_kings));
+    game->hash = ComputeHash(game);
 }
 
 // Converts row and column to bit position
@@ -7,6 +7,7 @@ typedef struct {
     unsigned long long red_kings;       // Red king pieces
     unsigned long long black_pieces;    // Regular black pieces
     unsigned long long black_kings;     // Black king pieces
+    unsigned long long hash;            // Zobrist key, updated incrementally by every move
     int current_player;                 // 0 = Red, 1 = Black
     int game_over;                      // Flag for game end
 } GameState;
@@ -16,7 +17,6 @@ extern const unsigned long long PLAYABLE_SQUARES;
 
 // Board functions
 void InitializeGame(GameState* game);
-void DisplayBoard(GameState* game);
 int GetPosition(int row, int col);
 int IsValidPosition(int row, int col);
 
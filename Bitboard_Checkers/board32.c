@@ -0,0 +1,52 @@
+#include "board32.h"
+#include "board.h"
+
+/**
+ * Packs the dark squares of a 64-bit bitboard into 32 bits
+ * Aligns every row's dark squares onto even bits, then squeezes out the
+ * gaps in log2 steps (bits -> pairs -> nibbles -> bytes -> words).
+ * @param bb Bitboard in the 64-bit layout (light squares ignored)
+ * @return Bitboard in the compact layout
+ */
+unsigned int PackBitboard(unsigned long long bb) {
+    unsigned long long x = ((bb >> 1) & 0x0055005500550055ULL) | (bb & 0x5500550055005500ULL);
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return (unsigned int)x;
+}
+
+// Spreads a compact bitboard back onto the dark squares of the 64-bit layout
+unsigned long long UnpackBitboard(unsigned int bb) {
+    unsigned long long x = bb;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return ((x & 0x0055005500550055ULL) << 1) | (x & 0x5500550055005500ULL);
+}
+
+// Converts a GameState to the compact layout
+void PackState(const GameState* game, CompactState* compact) {
+    compact->hash = game->hash;
+    compact->red_men = PackBitboard(game->red_pieces);
+    compact->red_kings = PackBitboard(game->red_kings);
+    compact->black_men = PackBitboard(game->black_pieces);
+    compact->black_kings = PackBitboard(game->black_kings);
+    compact->current_player = (unsigned int)game->current_player;
+}
+
+// Converts a compact position back to a GameState (game_over is cleared)
+void UnpackState(const CompactState* compact, GameState* game) {
+    game->red_pieces = UnpackBitboard(compact->red_men);
+    game->red_kings = UnpackBitboard(compact->red_kings);
+    game->black_pieces = UnpackBitboard(compact->black_men);
+    game->black_kings = UnpackBitboard(compact->black_kings);
+    game->hash = compact->hash;
+    game->current_player = (int)compact->current_player;
+    game->game_over = 0;
+}
+
@@ -0,0 +1,34 @@
+#ifndef BOARD32_H
+#define BOARD32_H
+
+#include "board.h"
+
+// Compact layout: the 32 dark squares numbered 0-31, four per row.
+// Square s is bit (s >> 1) of the 64-bit layout's position, so
+// s = pos / 2 and pos = 2 * s + (1 if row s / 4 is even).
+#define SQUARE32_TO_POS(s) (2 * (s) + ((((s) >> 2) & 1) ^ 1))
+#define POS_TO_SQUARE32(pos) ((pos) >> 1)
+
+// The four squares of row r in the compact layout
+#define ROW32(r)      (0xFU << (4 * (r)))
+
+// Compact position: four 32-bit bitboards plus key and side to move.
+// 32 bytes, so two positions share a cache line.
+typedef struct {
+    unsigned long long hash;        // Zobrist key of the full GameState
+    unsigned int red_men;
+    unsigned int red_kings;
+    unsigned int black_men;
+    unsigned int black_kings;
+    unsigned int current_player;    // 0 = Red, 1 = Black
+} CompactState;
+
+// Bitboard conversion between layouts
+unsigned int PackBitboard(unsigned long long bb);
+unsigned long long UnpackBitboard(unsigned int bb);
+
+// Whole-position conversion
+void PackState(const GameState* game, CompactState* compact);
+void UnpackState(const CompactState* compact, GameState* game);
+
+#endif // BOARD32_H
@@ -0,0 +1,232 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "book.h"
+#include "movegen.h"
+
+// Book used by the engine and the game (read only once mapped)
+static const unsigned char* book_map = NULL;
+static size_t book_map_size = 0;
+static const BookEntry* book_entries = NULL;
+static unsigned long long book_count = 0;
+
+// Starts an empty builder
+void BookBuilderInit(BookBuilder* builder) {
+    builder->entries = NULL;
+    builder->count = 0;
+    builder->capacity = 0;
+}
+
+// Releases a builder's entries
+void BookBuilderFree(BookBuilder* builder) {
+    free(builder->entries);
+    BookBuilderInit(builder);
+}
+
+/**
+ * Adds the opening moves of a finished game
+ * Every (position, move) pair is stored as it is met; duplicates are merged
+ * when the book is written, which keeps adding games a plain append.
+ * @param builder Builder to add to
+ * @param record Game record (unfinished games are skipped)
+ * @param max_plies Only the first max_plies moves are used
+ * @return Number of moves added (0 if out of memory or the game has no result)
+ */
+int BookBuilderAddGame(BookBuilder* builder, const GameRecord* record, int max_plies) {
+    if (record->result == RESULT_NONE) return 0;
+
+    GameState game;
+    RecordReplay(record, 0, &game);
+    int plies = record->ply_count < max_plies ? record->ply_count : max_plies;
+    int added = 0;
+    for (int ply = 0; ply < plies; ply++) {
+        MoveList list;
+        GenerateMoves(&game, &list);
+        // A code that decodes to no move, or to several captures, would store
+        // a move other than the one played; the game is not followed past it
+        const Move* move = FindEncodedMove(&list, record->moves[ply]);
+        if (move == NULL) break;
+
+        if (builder->count == builder->capacity) {
+            size_t capacity = builder->capacity ? builder->capacity * 2 : 4096;
+            BookEntry* entries = realloc(builder->entries, capacity * sizeof(BookEntry));
+            if (entries == NULL) return added;
+            builder->entries = entries;
+            builder->capacity = capacity;
+        }
+
+        int mover_won = (record->result == RESULT_RED_WINS && game.current_player == 0) ||
+                        (record->result == RESULT_BLACK_WINS && game.current_player == 1);
+        BookEntry* entry = &builder->entries[builder->count++];
+        entry->hash = game.hash;
+        entry->move = record->moves[ply];
+        entry->reserved = 0;
+        entry->games = 1;
+        entry->wins = mover_won;
+        entry->draws = record->result == RESULT_DRAW;
+        added++;
+
+        DoMove(&game, move);
+    }
+    return added;
+}
+
+// Orders entries by position key, then by move
+static int CompareEntries(const void* a, const void* b) {
+    const BookEntry* x = a;
+    const BookEntry* y = b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return (int)x->move - (int)y->move;
+}
+
+/**
+ * Sorts and merges the collected entries and writes them as a book file
+ * @param builder Builder holding the entries (left sorted and merged)
+ * @param filename Output file
+ * @param min_games Moves played in fewer games are left out
+ * @param written Output: number of entries in the file (may be NULL)
+ * @return FILE_OK, FILE_ERROR_OPEN or FILE_ERROR_WRITE
+ */
+FileStatus BookBuilderWrite(BookBuilder* builder, const char* filename, unsigned int min_games,
+                            unsigned long long* written) {
+    qsort(builder->entries, builder->count, sizeof(BookEntry), CompareEntries);
+
+    size_t merged = 0;
+    for (size_t i = 0; i < builder->count; i++) {
+        BookEntry* last = merged > 0 ? &builder->entries[merged - 1] : NULL;
+        const BookEntry* entry = &builder->entries[i];
+        if (last != NULL && last->hash == entry->hash && last->move == entry->move) {
+            last->games += entry->games;
+            last->wins += entry->wins;
+            last->draws += entry->draws;
+        } else {
+            builder->entries[merged++] = *entry;
+        }
+    }
+    builder->count = merged;
+
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return FILE_ERROR_OPEN;
+    }
+
+    BookFileHeader header = { BOOK_MAGIC, BOOK_VERSION, 0 };
+    for (size_t i = 0; i < builder->count; i++) {
+        if (builder->entries[i].games >= min_games) header.count++;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t i = 0; i < builder->count && ok; i++) {
+        if (builder->entries[i].games >= min_games) {
+            ok = fwrite(&builder->entries[i], sizeof(BookEntry), 1, file) == 1;
+        }
+    }
+    if (fclose(file) != 0) ok = 0;
+    if (written != NULL) *written = header.count;
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+/**
+ * Maps a book file for probing, replacing any book already in use
+ * @param filename Book file written by BookBuilderWrite
+ * @return FILE_OK, FILE_ERROR_OPEN or FILE_ERROR_FORMAT
+ */
+FileStatus BookInit(const char* filename) {
+    BookClose();
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return FILE_ERROR_OPEN;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(BookFileHeader)) {
+        close(fd);
+        return FILE_ERROR_FORMAT;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return FILE_ERROR_OPEN;
+    }
+
+    const BookFileHeader* header = map;
+    if (header->magic != BOOK_MAGIC || header->version != BOOK_VERSION ||
+        header->count != (info.st_size - sizeof(BookFileHeader)) / sizeof(BookEntry)) {
+        munmap(map, info.st_size);
+        return FILE_ERROR_FORMAT;
+    }
+
+    book_map = map;
+    book_map_size = info.st_size;
+    book_entries = (const BookEntry*)(book_map + sizeof(BookFileHeader));
+    book_count = header->count;
+    return FILE_OK;
+}
+
+// Unmaps the book (no search may be running)
+void BookClose(void) {
+    if (book_map != NULL) munmap((void*)book_map, book_map_size);
+    book_map = NULL;
+    book_map_size = 0;
+    book_entries = NULL;
+    book_count = 0;
+}
+
+// Number of (position, move) entries in the book (0 if none is loaded)
+unsigned long long BookSize(void) {
+    return book_count;
+}
+
+/**
+ * Finds the book moves of a position
+ * @param game Position
+ * @param entries Output: first entry of the position (points into the mapping)
+ * @return Number of entries for the position (0 if it is not in the book)
+ */
+int BookProbe(const GameState* game, const BookEntry** entries) {
+    unsigned long long low = 0, high = book_count;
+    while (low < high) {
+        unsigned long long middle = low + (high - low) / 2;
+        if (book_entries[middle].hash < game->hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    int count = 0;
+    while (low + count < book_count && book_entries[low + count].hash == game->hash) count++;
+    *entries = count > 0 ? &book_entries[low] : NULL;
+    return count;
+}
+
+/**
+ * Picks the book move for a position: the one played in the most games,
+ * with the better score breaking ties
+ * @param game Position
+ * @param list Legal moves of the position (entries whose code matches none,
+ *             or several, of them are skipped)
+ * @return Chosen move from list, or NULL if the position is not in the book
+ */
+const Move* BookSelectMove(const GameState* game, const MoveList* list) {
+    const BookEntry* entries;
+    int count = BookProbe(game, &entries);
+
+    const Move* best = NULL;
+    unsigned int best_games = 0;
+    unsigned long long best_points = 0;
+    for (int i = 0; i < count; i++) {
+        const Move* move = FindEncodedMove(list, entries[i].move);
+        if (move == NULL) continue;
+        unsigned long long points = 2ULL * entries[i].wins + entries[i].draws;
+        if (entries[i].games > best_games || (entries[i].games == best_games && points > best_points)) {
+            best = move;
+            best_games = entries[i].games;
+            best_points = points;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,54 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "archive.h"
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+
+// Book files are a header followed by entries sorted by (hash, move), so all
+// moves of a position are adjacent and found by binary search in the mapping
+#define BOOK_MAGIC   0x4B424B43U    // "CKBK"
+#define BOOK_VERSION 1
+
+// Default depth of the positions a book is built from (plies from the start)
+#define BOOK_DEFAULT_PLIES 16
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long count;
+} BookFileHeader;
+
+// One move played in one position, with the results it led to
+typedef struct {
+    unsigned long long hash;            // Zobrist key of the position (pieces and side to move)
+    unsigned short move;                // EncodeMove code
+    unsigned short reserved;
+    unsigned int games;
+    unsigned int wins;                  // For the side that played the move
+    unsigned int draws;
+} BookEntry;
+
+// Collects entries from game records in memory before they are written
+typedef struct {
+    BookEntry* entries;
+    size_t count;
+    size_t capacity;
+} BookBuilder;
+
+// Building
+void BookBuilderInit(BookBuilder* builder);
+void BookBuilderFree(BookBuilder* builder);
+int BookBuilderAddGame(BookBuilder* builder, const GameRecord* record, int max_plies);
+FileStatus BookBuilderWrite(BookBuilder* builder, const char* filename, unsigned int min_games,
+                            unsigned long long* written);
+
+// Probing (the file is memory mapped; nothing is parsed at load time)
+FileStatus BookInit(const char* filename);
+void BookClose(void);
+unsigned long long BookSize(void);
+int BookProbe(const GameState* game, const BookEntry** entries);
+const Move* BookSelectMove(const GameState* game, const MoveList* list);
+
+#endif // BOOK_H
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "archive.h"
+#include "bitops.h"
+#include "book.h"
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    const char* output = NULL;
+    const char* inputs[64];
+    int input_count = 0;
+    int max_plies = BOOK_DEFAULT_PLIES;
+    int min_games = 2;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--plies") == 0 && has_value) {
+            max_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-games") == 0 && has_value) {
+            min_games = atoi(argv[++i]);
+        } else if (output == NULL) {
+            output = argv[i];
+        } else if (input_count < 64) {
+            inputs[input_count++] = argv[i];
+        }
+    }
+
+    if (output == NULL || input_count == 0 || max_plies <= 0 || min_games <= 0) {
+        printf("Usage: %s <output.book> <archive>... [--plies N] [--min-games N]\n", argv[0]);
+        printf("Builds an opening book from the first N plies (default %d) of finished games.\n",
+               BOOK_DEFAULT_PLIES);
+        printf("Moves played in fewer than --min-games games (default 2) are left out.\n");
+        return 1;
+    }
+
+    BookBuilder builder;
+    BookBuilderInit(&builder);
+    GameRecord* record = malloc(sizeof(GameRecord));
+    unsigned long long games = 0;
+    for (int i = 0; i < input_count; i++) {
+        Archive archive;
+        if (ArchiveOpen(&archive, inputs[i]) != FILE_OK) {
+            printf("Error: Could not read archive '%s'!\n", inputs[i]);
+            return 1;
+        }
+        for (unsigned long long n = 0; n < archive.count; n++) {
+            if (ArchiveGetGame(&archive, n, record) && BookBuilderAddGame(&builder, record, max_plies) > 0) {
+                games++;
+            }
+        }
+        ArchiveClose(&archive);
+    }
+    free(record);
+
+    unsigned long long moves = builder.count;
+    unsigned long long written;
+    if (BookBuilderWrite(&builder, output, (unsigned int)min_games, &written) != FILE_OK) {
+        printf("Error: Could not write '%s'!\n", output);
+        return 1;
+    }
+    printf("Games:   %llu\n", games);
+    printf("Moves:   %llu (%llu distinct)\n", moves, (unsigned long long)builder.count);
+    printf("Entries: %llu written to '%s' (%llu bytes)\n", written, output,
+           (unsigned long long)(sizeof(BookFileHeader) + written * sizeof(BookEntry)));
+    BookBuilderFree(&builder);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef CHECKERS_H
+#define CHECKERS_H
+
+// Public interface of libcheckers: rules, move generation, search and
+// tables. Nothing in the library writes to the terminal; every function
+// reports through return values (status enums, EVENT_* flags, results).
+#include "bitops.h"
+#include "board.h"
+#include "board32.h"
+#include "movegen.h"
+#include "arena.h"
+#include "history.h"
+#include "game.h"
+#include "archive.h"
+#include "zobrist.h"
+#include "tt.h"
+#include "eval.h"
+#include "search.h"
+#include "nnue.h"
+#include "book.h"
+#include "stats.h"
+#include "notation.h"
+#include "tablebase.h"
+
+#endif // CHECKERS_H
@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <string.h>
+#include "eval.h"
+#include "bitops.h"
+#include "board.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+// Back rows: keeping men here stops the opponent from crowning
+#define RED_BACK_ROW   0x00000000000000FFULL
+#define BLACK_BACK_ROW 0xFF00000000000000ULL
+
+// Central squares (rows 3-4, columns 2-5)
+#define CENTER_SQUARES 0x0000003C3C000000ULL
+
+// Rows a man has advanced, as bit planes: a man on a row with bit k of its
+// advance set is counted with weight 2^k (red advances from row 0, black from row 7)
+#define RED_ADVANCE_1   0xFF00FF00FF00FF00ULL   // Rows 1, 3, 5, 7
+#define RED_ADVANCE_2   0xFFFF0000FFFF0000ULL   // Rows 2, 3, 6, 7
+#define RED_ADVANCE_4   0xFFFFFFFF00000000ULL   // Rows 4-7
+#define BLACK_ADVANCE_1 0x00FF00FF00FF00FFULL   // Rows 6, 4, 2, 0
+#define BLACK_ADVANCE_2 0x0000FFFF0000FFFFULL   // Rows 5, 4, 1, 0
+#define BLACK_ADVANCE_4 0x00000000FFFFFFFFULL   // Rows 3-0
+
+// Scores one side: material, advancement, back-row guard, center control and mobility
+// (always inlined, so the POPCNT build of EvaluateRed below gets its own copy)
+static inline __attribute__((always_inline)) int EvaluateSide(unsigned long long men, unsigned long long kings, unsigned long long empty, int is_red) {
+    int score = CountBits(men) * MAN_VALUE + CountBits(kings) * KING_VALUE;
+
+    int advance = is_red
+        ? CountBits(men & RED_ADVANCE_1) + 2 * CountBits(men & RED_ADVANCE_2) + 4 * CountBits(men & RED_ADVANCE_4)
+        : CountBits(men & BLACK_ADVANCE_1) + 2 * CountBits(men & BLACK_ADVANCE_2) + 4 * CountBits(men & BLACK_ADVANCE_4);
+    score += advance * ADVANCE_WEIGHT;
+
+    score += CountBits(men & (is_red ? RED_BACK_ROW : BLACK_BACK_ROW)) * BACK_ROW_WEIGHT;
+    score += CountBits((men | kings) & CENTER_SQUARES) * CENTER_WEIGHT;
+
+    // Steps off the board edge land on light squares, which are never empty
+    unsigned long long up = is_red ? men | kings : kings;
+    unsigned long long down = is_red ? kings : men | kings;
+    int mobility = CountBits((up << 7) & empty) + CountBits((up << 9) & empty) +
+                   CountBits((down >> 7) & empty) + CountBits((down >> 9) & empty);
+    score += mobility * MOBILITY_WEIGHT;
+    return score;
+}
+
+// Red's score minus black's
+static int EvaluateRed(unsigned long long red_men, unsigned long long red_kings,
+                       unsigned long long black_men, unsigned long long black_kings) {
+    unsigned long long empty = PLAYABLE_SQUARES & ~(red_men | red_kings | black_men | black_kings);
+    return EvaluateSide(red_men, red_kings, empty, 1) - EvaluateSide(black_men, black_kings, empty, 0);
+}
+
+#ifdef HAVE_X86_SIMD
+// The same terms built for CPUs with POPCNT, which the default build cannot assume
+__attribute__((target("popcnt")))
+static int EvaluateRedPopcnt(unsigned long long red_men, unsigned long long red_kings,
+                             unsigned long long black_men, unsigned long long black_kings) {
+    unsigned long long empty = PLAYABLE_SQUARES & ~(red_men | red_kings | black_men | black_kings);
+    return EvaluateSide(red_men, red_kings, empty, 1) - EvaluateSide(black_men, black_kings, empty, 0);
+}
+#endif
+
+/**
+ * Scores a position statically
+ * @param game Pointer to game state
+ * @return Score in centi-men, positive when the side to move is better
+ */
+int Evaluate(const GameState* game) {
+#ifdef HAVE_X86_SIMD
+    if (cpu_features & CPU_POPCNT) {
+        int red = EvaluateRedPopcnt(game->red_pieces, game->red_kings, game->black_pieces, game->black_kings);
+        return game->current_player == 0 ? red : -red;
+    }
+#endif
+    int red = EvaluateRed(game->red_pieces, game->red_kings, game->black_pieces, game->black_kings);
+    return game->current_player == 0 ? red : -red;
+}
+
+/**
+ * Allocates a block's arrays (64-byte aligned for vector loads)
+ * @param block Block to initialize (empty)
+ * @param capacity Most positions the block can hold
+ * @return 1 on success, 0 if allocation failed
+ */
+int PositionBlockInit(PositionBlock* block, int capacity) {
+    memset(block, 0, sizeof(*block));
+    size_t bitboard_bytes = ((size_t)capacity * sizeof(unsigned long long) + 63) & ~(size_t)63;
+    size_t side_bytes = ((size_t)capacity + 63) & ~(size_t)63;
+
+    block->red_pieces = aligned_alloc(64, bitboard_bytes);
+    block->red_kings = aligned_alloc(64, bitboard_bytes);
+    block->black_pieces = aligned_alloc(64, bitboard_bytes);
+    block->black_kings = aligned_alloc(64, bitboard_bytes);
+    block->current_player = aligned_alloc(64, side_bytes);
+    if (!block->red_pieces || !block->red_kings || !block->black_pieces ||
+        !block->black_kings || !block->current_player) {
+        PositionBlockFree(block);
+        return 0;
+    }
+    block->capacity = capacity;
+    return 1;
+}
+
+// Releases a block's arrays
+void PositionBlockFree(PositionBlock* block) {
+    free(block->red_pieces);
+    free(block->red_kings);
+    free(block->black_pieces);
+    free(block->black_kings);
+    free(block->current_player);
+    memset(block, 0, sizeof(*block));
+}
+
+// Appends a position; returns 0 if the block is full
+int PositionBlockAdd(PositionBlock* block, const GameState* game) {
+    if (block->count >= block->capacity) return 0;
+    int i = block->count++;
+    block->red_pieces[i] = game->red_pieces;
+    block->red_kings[i] = game->red_kings;
+    block->black_pieces[i] = game->black_pieces;
+    block->black_kings[i] = game->black_kings;
+    block->current_player[i] = (unsigned char)game->current_player;
+    return 1;
+}
+
+// Scores positions [start, block->count) one at a time
+static void EvaluateRange(const PositionBlock* block, int start, int* scores) {
+    for (int i = start; i < block->count; i++) {
+        int red = EvaluateRed(block->red_pieces[i], block->red_kings[i],
+                              block->black_pieces[i], block->black_kings[i]);
+        scores[i] = block->current_player[i] == 0 ? red : -red;
+    }
+}
+
+// Portable batch evaluation (the reference the vector paths must match)
+void EvaluateBatchScalar(const PositionBlock* block, int* scores) {
+    EvaluateRange(block, 0, scores);
+}
+
+#ifdef HAVE_X86_SIMD
+
+// Per-lane popcount of four 64-bit lanes: nibble lookups summed per lane
+__attribute__((target("avx2")))
+static inline __m256i Popcount4(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi64(v, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+// Weighted popcount of (v & mask), added to sum
+__attribute__((target("avx2")))
+static inline __m256i AddCount4(__m256i sum, __m256i v, unsigned long long mask, unsigned int weight) {
+    __m256i count = Popcount4(_mm256_and_si256(v, _mm256_set1_epi64x((long long)mask)));
+    return _mm256_add_epi64(sum, _mm256_mul_epu32(count, _mm256_set1_epi64x(weight)));
+}
+
+// EvaluateSide for four positions at once
+__attribute__((target("avx2")))
+static inline __m256i EvaluateSide4(__m256i men, __m256i kings, __m256i empty, int is_red) {
+    const unsigned long long all = ~0ULL;
+    __m256i score = _mm256_setzero_si256();
+    score = AddCount4(score, men, all, MAN_VALUE);
+    score = AddCount4(score, kings, all, KING_VALUE);
+    score = AddCount4(score, men, is_red ? RED_ADVANCE_1 : BLACK_ADVANCE_1, ADVANCE_WEIGHT);
+    score = AddCount4(score, men, is_red ? RED_ADVANCE_2 : BLACK_ADVANCE_2, 2 * ADVANCE_WEIGHT);
+    score = AddCount4(score, men, is_red ? RED_ADVANCE_4 : BLACK_ADVANCE_4, 4 * ADVANCE_WEIGHT);
+    score = AddCount4(score, men, is_red ? RED_BACK_ROW : BLACK_BACK_ROW, BACK_ROW_WEIGHT);
+    score = AddCount4(score, _mm256_or_si256(men, kings), CENTER_SQUARES, CENTER_WEIGHT);
+
+    __m256i up = is_red ? _mm256_or_si256(men, kings) : kings;
+    __m256i down = is_red ? kings : _mm256_or_si256(men, kings);
+    score = AddCount4(score, _mm256_and_si256(_mm256_slli_epi64(up, 7), empty), all, MOBILITY_WEIGHT);
+    score = AddCount4(score, _mm256_and_si256(_mm256_slli_epi64(up, 9), empty), all, MOBILITY_WEIGHT);
+    score = AddCount4(score, _mm256_and_si256(_mm256_srli_epi64(down, 7), empty), all, MOBILITY_WEIGHT);
+    score = AddCount4(score, _mm256_and_si256(_mm256_srli_epi64(down, 9), empty), all, MOBILITY_WEIGHT);
+    return score;
+}
+
+// AVX2 batch evaluation: four positions per step
+__attribute__((target("avx2")))
+static void EvaluateBatchAVX2(const PositionBlock* block, int* scores) {
+    const __m256i playable = _mm256_set1_epi64x((long long)PLAYABLE_SQUARES);
+    int i = 0;
+    for (; i + 4 <= block->count; i += 4) {
+        __m256i red_men = _mm256_loadu_si256((const __m256i*)(block->red_pieces + i));
+        __m256i red_kings = _mm256_loadu_si256((const __m256i*)(block->red_kings + i));
+        __m256i black_men = _mm256_loadu_si256((const __m256i*)(block->black_pieces + i));
+        __m256i black_kings = _mm256_loadu_si256((const __m256i*)(block->black_kings + i));
+        __m256i occupied = _mm256_or_si256(_mm256_or_si256(red_men, red_kings),
+                                           _mm256_or_si256(black_men, black_kings));
+        __m256i empty = _mm256_andnot_si256(occupied, playable);
+
+        __m256i red = _mm256_sub_epi64(EvaluateSide4(red_men, red_kings, empty, 1),
+                                       EvaluateSide4(black_men, black_kings, empty, 0));
+        long long lanes[4];
+        _mm256_storeu_si256((__m256i*)lanes, red);
+        for (int lane = 0; lane < 4; lane++) {
+            scores[i + lane] = block->current_player[i + lane] == 0 ? (int)lanes[lane] : -(int)lanes[lane];
+        }
+    }
+    EvaluateRange(block, i, scores);
+}
+
+// Weighted popcount of (v & mask) over eight lanes, added to sum
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static inline __m512i AddCount8(__m512i sum, __m512i v, unsigned long long mask, unsigned int weight) {
+    __m512i count = _mm512_popcnt_epi64(_mm512_and_si512(v, _mm512_set1_epi64((long long)mask)));
+    return _mm512_add_epi64(sum, _mm512_mul_epu32(count, _mm512_set1_epi64(weight)));
+}
+
+// EvaluateSide for eight positions at once
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static inline __m512i EvaluateSide8(__m512i men, __m512i kings, __m512i empty, int is_red) {
+    const unsigned long long all = ~0ULL;
+    __m512i score = _mm512_setzero_si512();
+    score = AddCount8(score, men, all, MAN_VALUE);
+    score = AddCount8(score, kings, all, KING_VALUE);
+    score = AddCount8(score, men, is_red ? RED_ADVANCE_1 : BLACK_ADVANCE_1, ADVANCE_WEIGHT);
+    score = AddCount8(score, men, is_red ? RED_ADVANCE_2 : BLACK_ADVANCE_2, 2 * ADVANCE_WEIGHT);
+    score = AddCount8(score, men, is_red ? RED_ADVANCE_4 : BLACK_ADVANCE_4, 4 * ADVANCE_WEIGHT);
+    score = AddCount8(score, men, is_red ? RED_BACK_ROW : BLACK_BACK_ROW, BACK_ROW_WEIGHT);
+    score = AddCount8(score, _mm512_or_si512(men, kings), CENTER_SQUARES, CENTER_WEIGHT);
+
+    __m512i up = is_red ? _mm512_or_si512(men, kings) : kings;
+    __m512i down = is_red ? kings : _mm512_or_si512(men, kings);
+    score = AddCount8(score, _mm512_and_si512(_mm512_slli_epi64(up, 7), empty), all, MOBILITY_WEIGHT);
+    score = AddCount8(score, _mm512_and_si512(_mm512_slli_epi64(up, 9), empty), all, MOBILITY_WEIGHT);
+    score = AddCount8(score, _mm512_and_si512(_mm512_srli_epi64(down, 7), empty), all, MOBILITY_WEIGHT);
+    score = AddCount8(score, _mm512_and_si512(_mm512_srli_epi64(down, 9), empty), all, MOBILITY_WEIGHT);
+    return score;
+}
+
+// AVX-512 batch evaluation: eight positions per step, native 64-bit popcount
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void EvaluateBatchAVX512(const PositionBlock* block, int* scores) {
+    const __m512i playable = _mm512_set1_epi64((long long)PLAYABLE_SQUARES);
+    int i = 0;
+    for (; i + 8 <= block->count; i += 8) {
+        __m512i red_men = _mm512_loadu_si512(block->red_pieces + i);
+        __m512i red_kings = _mm512_loadu_si512(block->red_kings + i);
+        __m512i black_men = _mm512_loadu_si512(block->black_pieces + i);
+        __m512i black_kings = _mm512_loadu_si512(block->black_kings + i);
+        __m512i occupied = _mm512_or_si512(_mm512_or_si512(red_men, red_kings),
+                                           _mm512_or_si512(black_men, black_kings));
+        __m512i empty = _mm512_andnot_si512(occupied, playable);
+
+        __m512i red = _mm512_sub_epi64(EvaluateSide8(red_men, red_kings, empty, 1),
+                                       EvaluateSide8(black_men, black_kings, empty, 0));
+
+        // Negate the lanes where black is to move, then narrow to 32 bits
+        __m128i sides = _mm_loadl_epi64((const __m128i*)(block->current_player + i));
+        __mmask8 black_to_move = _mm512_test_epi64_mask(_mm512_cvtepu8_epi64(sides), _mm512_set1_epi64(1));
+        red = _mm512_mask_sub_epi64(red, black_to_move, _mm512_setzero_si512(), red);
+        _mm256_storeu_si256((__m256i*)(scores + i), _mm512_cvtepi64_epi32(red));
+    }
+    EvaluateRange(block, i, scores);
+}
+
+#endif // HAVE_X86_SIMD
+
+/**
+ * Scores every position of a block
+ * Uses the widest vector unit InitBitops found (AVX-512, AVX2, else
+ * scalar); all paths compute the same terms with the same weights, so the
+ * scores are identical to calling Evaluate on each position.
+ * @param block Positions to score
+ * @param scores Output: one score per position, from its side to move's view
+ */
+void EvaluateBatch(const PositionBlock* block, int* scores) {
+#ifdef HAVE_X86_SIMD
+    if (cpu_features & CPU_AVX512) {
+        EvaluateBatchAVX512(block, scores);
+        return;
+    }
+    if (cpu_features & CPU_AVX2) {
+        EvaluateBatchAVX2(block, scores);
+        return;
+    }
+#endif
+    EvaluateBatchScalar(block, scores);
+}
+
+// Name of the code path EvaluateBatch uses on this CPU
+const char* EvaluateBatchBackend(void) {
+#ifdef HAVE_X86_SIMD
+    if (cpu_features & CPU_AVX512) return "AVX-512";
+    if (cpu_features & CPU_AVX2) return "AVX2";
+#endif
+    return "scalar";
+}
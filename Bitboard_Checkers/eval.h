@@ -0,0 +1,41 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "board.h"
+
+// Piece values in centi-men
+#define MAN_VALUE  100
+#define KING_VALUE 130
+
+// Positional weights in centi-men
+#define ADVANCE_WEIGHT   2      // Per row a man has advanced
+#define BACK_ROW_WEIGHT  6      // Per man guarding its own back row
+#define CENTER_WEIGHT    4      // Per piece on the central squares
+#define MOBILITY_WEIGHT  1      // Per available non-capturing step
+
+// Structure-of-arrays block of positions for batch evaluation:
+// position i is (red_pieces[i], red_kings[i], black_pieces[i], black_kings[i], current_player[i])
+typedef struct {
+    unsigned long long* red_pieces;
+    unsigned long long* red_kings;
+    unsigned long long* black_pieces;
+    unsigned long long* black_kings;
+    unsigned char* current_player;
+    int count;
+    int capacity;
+} PositionBlock;
+
+// Static evaluation from the side to move's point of view
+int Evaluate(const GameState* game);
+
+// Blocks of positions
+int PositionBlockInit(PositionBlock* block, int capacity);
+void PositionBlockFree(PositionBlock* block);
+int PositionBlockAdd(PositionBlock* block, const GameState* game);
+
+// Batch evaluation: scores[i] equals Evaluate() of position i on every code path
+void EvaluateBatch(const PositionBlock* block, int* scores);
+void EvaluateBatchScalar(const PositionBlock* block, int* scores);
+const char* EvaluateBatchBackend(void);
+
+#endif // EVAL_H
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "board.h"
+#include "eval.h"
+#include "movegen.h"
+#include "nnue.h"
+
+// Parity checks between code paths that must give identical results:
+// every EvaluateBatch backend against the scalar Evaluate, and NNUE
+// accumulators updated move by move against a full refresh. Positions come
+// from seeded random games plus random piece placements, so a failure
+// reproduces on every run. Exits with 1 on the first mismatch.
+
+#define TEST_GAMES      200
+#define TEST_MAX_PLIES  200
+#define TEST_RANDOM     20000
+#define TEST_SEED       0x7465737473ULL     // "tests"
+
+// Most kept positions: every game ply plus the random placements
+#define TEST_POSITIONS (TEST_GAMES * TEST_MAX_PLIES + TEST_RANDOM)
+
+static unsigned long long NextRandom(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// A position with up to 12 pieces per side, men and kings, on random dark squares
+static void RandomPosition(GameState* game, unsigned long long* seed) {
+    memset(game, 0, sizeof(*game));
+    int red = 0, black = 0;
+    int pos;
+    FOR_EACH_BIT(pos, PLAYABLE_SQUARES) {
+        unsigned long long bit = 1ULL << pos;
+        switch (NextRandom(seed) % 8) {
+        case 0: if (red < 12) { game->red_pieces |= bit; red++; } break;
+        case 1: if (red < 12) { game->red_kings |= bit; red++; } break;
+        case 2: if (black < 12) { game->black_pieces |= bit; black++; } break;
+        case 3: if (black < 12) { game->black_kings |= bit; black++; } break;
+        default: break;
+        }
+    }
+    game->current_player = (int)(NextRandom(seed) & 1);
+}
+
+// Fills the block with the positions of seeded random games, then random placements
+static int BuildPositions(PositionBlock* block, GameState* positions) {
+    unsigned long long seed = TEST_SEED;
+    if (!PositionBlockInit(block, TEST_POSITIONS)) return 0;
+
+    for (int g = 0; g < TEST_GAMES; g++) {
+        GameState game;
+        InitializeGame(&game);
+        for (int ply = 0; ply < TEST_MAX_PLIES; ply++) {
+            MoveList list;
+            if (GenerateMoves(&game, &list) == 0) break;
+            positions[block->count] = game;
+            PositionBlockAdd(block, &game);
+            DoMove(&game, &list.moves[NextRandom(&seed) % list.count]);
+        }
+    }
+    for (int i = 0; i < TEST_RANDOM; i++) {
+        RandomPosition(&positions[block->count], &seed);
+        PositionBlockAdd(block, &positions[block->count]);
+    }
+    return 1;
+}
+
+// Runs every EvaluateBatch backend this CPU has against Evaluate; returns the number of mismatches
+static int TestEvaluateBatch(const PositionBlock* block, const GameState* positions) {
+    const int detected = cpu_features;
+    // The scalar run also turns off POPCNT, so Evaluate's two builds are both checked
+    const int masks[] = { 0, CPU_AVX512, CPU_AVX512 | CPU_AVX2 | CPU_POPCNT };
+    int* scores = malloc(sizeof(int) * block->count);
+    if (scores == NULL) {
+        printf("Error: Could not allocate the scores!\n");
+        return 1;
+    }
+
+    int failures = 0;
+    const char* tested[3];
+    int tested_count = 0;
+    for (int m = 0; m < 3 && failures == 0; m++) {
+        cpu_features = detected & ~masks[m];
+        const char* backend = EvaluateBatchBackend();
+        int seen = 0;
+        for (int i = 0; i < tested_count; i++) {
+            if (strcmp(tested[i], backend) == 0) seen = 1;
+        }
+        if (seen) continue;
+        tested[tested_count++] = backend;
+
+        EvaluateBatch(block, scores);
+        int mismatches = 0;
+        for (int i = 0; i < block->count; i++) {
+            int expected = Evaluate(&positions[i]);
+            if (scores[i] == expected) continue;
+            if (mismatches++ == 0) {
+                printf("  position %d: batch %d, Evaluate %d\n", i, scores[i], expected);
+            }
+        }
+        printf("EvaluateBatch (%s) vs Evaluate: %d positions, %d mismatches\n",
+               backend, block->count, mismatches);
+        failures += mismatches;
+    }
+    cpu_features = detected;
+    free(scores);
+    return failures;
+}
+
+// Random quantized weights small enough that no accumulator sum overflows
+static int LoadRandomNetwork(unsigned long long* seed) {
+    NNUENetwork* net = aligned_alloc(64, sizeof(NNUENetwork));
+    if (net == NULL) return 0;
+    for (int f = 0; f < NNUE_FEATURES; f++) {
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            net->feature_weights[f][j] = (short)((int)(NextRandom(seed) % 128) - 64);
+        }
+    }
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        net->feature_biases[j] = (short)((int)(NextRandom(seed) % 256) - 64);
+    }
+    for (int j = 0; j < 2 * NNUE_HIDDEN; j++) {
+        net->output_weights[j] = (signed char)((int)(NextRandom(seed) % 128) - 64);
+    }
+    net->output_bias = (int)(NextRandom(seed) % 20000) - 10000;
+    net->output_scale = 400;
+
+    char path[] = "/tmp/evaltest-XXXXXX";
+    int fd = mkstemp(path);
+    int ok = fd >= 0;
+    if (ok) {
+        close(fd);
+        ok = NNUESave(net, path) == FILE_OK && NNUELoad(path) == FILE_OK;
+        remove(path);
+    }
+    free(net);
+    return ok;
+}
+
+// Plays seeded random games carrying the accumulators along with NNUEUpdate
+// and compares them, and their scores, with a scalar refresh at every ply;
+// returns the number of mismatches
+static int TestNNUEUpdate(unsigned long long seed) {
+    const int detected = cpu_features;
+    int failures = 0;
+    int checked = 0;
+
+    for (int g = 0; g < TEST_GAMES && failures == 0; g++) {
+        GameState game;
+        InitializeGame(&game);
+        NNUEAccumulator current;
+        NNUERefresh(&game, &current);
+
+        for (int ply = 0; ply < TEST_MAX_PLIES; ply++) {
+            MoveList list;
+            if (GenerateMoves(&game, &list) == 0) break;
+            const Move* move = &list.moves[NextRandom(&seed) % list.count];
+
+            NNUEAccumulator child, full;
+            NNUEUpdate(&current, &child, game.current_player, move);
+            DoMove(&game, move);
+
+            cpu_features = detected & ~(CPU_AVX2 | CPU_AVX512);
+            NNUERefresh(&game, &full);
+            int expected = NNUEEvaluate(&full, game.current_player);
+            cpu_features = detected;
+            int score = NNUEEvaluate(&child, game.current_player);
+            checked++;
+
+            if (memcmp(child.values, full.values, sizeof(full.values)) != 0 || score != expected) {
+                if (failures++ == 0) {
+                    printf("  game %d ply %d: updated score %d, refreshed %d\n", g, ply, score, expected);
+                }
+                break;
+            }
+            current = child;
+        }
+    }
+    printf("NNUEUpdate (%s) vs NNUERefresh: %d positions, %d mismatches\n",
+           (cpu_features & CPU_AVX2) ? "AVX2" : "scalar", checked, failures);
+    return failures;
+}
+
+int main(void) {
+    InitBitops();
+
+    PositionBlock block;
+    GameState* positions = malloc(sizeof(GameState) * TEST_POSITIONS);
+    if (positions == NULL || !BuildPositions(&block, positions)) {
+        printf("Error: Could not allocate the test positions!\n");
+        free(positions);
+        return 1;
+    }
+    int failures = TestEvaluateBatch(&block, positions);
+    PositionBlockFree(&block);
+    free(positions);
+
+    unsigned long long seed = TEST_SEED;
+    if (!LoadRandomNetwork(&seed)) {
+        printf("Error: Could not load a test network!\n");
+        return 1;
+    }
+    // The updates on each code path this CPU has, always against the scalar refresh
+    const int detected = cpu_features;
+    if (detected & CPU_AVX2) failures += TestNNUEUpdate(seed);
+    cpu_features = detected & ~(CPU_AVX2 | CPU_AVX512);
+    failures += TestNNUEUpdate(seed);
+    cpu_features = detected;
+    NNUEUnload();
+
+    printf(failures == 0 ? "All parity checks passed\n" : "Parity checks FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -3,6 +3,9 @@
 #include "game.h"
 #include "bitops.h"
 #include "board.h"
+#include "notation.h"
+#include "stats.h"
+#include "zobrist.h"
 
 /**
  * Checks if a square is occupied by the current player
@@ -61,13 +64,15 @@ int IsKing(GameState* game, int position) {
  * @param from_col Starting column
  * @param to_row Destination row
  * @param to_col Destination column
- * @return 1 if move successful, 0 otherwise
+ * @param events Output (may be NULL): EVENT_* flags of the move, 0 if it was rejected
+ * @return MOVE_OK if the move was played, otherwise why it was rejected
  */
-int MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col) {
+MoveStatus MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col, int* events) {
+    if (events != NULL) *events = 0;
+    
     // Validate positions
     if (!IsValidPosition(from_row, from_col) || !IsValidPosition(to_row, to_col)) {
-        printf("Invalid position! Must be on dark squares.\n");
-        return 0;
+        return MOVE_ERROR_INVALID_POSITION;
     }
     
     int from_pos = GetPosition(from_row, from_col);
@@ -75,14 +80,12 @@ int MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col
     
     // Check if from position has current player's piece
     if (!IsOwnPiece(game, from_pos)) {
-        printf("No piece at that position or not your piece!\n");
-        return 0;
+        return MOVE_ERROR_NOT_OWN_PIECE;
     }
     
-    // Check if destination is empty
-    if (!IsEmpty(game, to_pos)) {
-        printf("Destination is not empty!\n");
-        return 0;
+    // Check if destination is empty (a king may circle back to its own square)
+    if (to_pos != from_pos && !IsEmpty(game, to_pos)) {
+        return MOVE_ERROR_DESTINATION_OCCUPIED;
     }
     
     int row_diff = to_row - from_row;
@@ -92,49 +95,111 @@ int MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col
     // Validate move direction for non-kings
     if (!is_king_piece) {
         if (game->current_player == 0 && row_diff <= 0) {  // Red moves up
-            printf("Regular red pieces must move forward (up)!\n");
-            return 0;
+            return MOVE_ERROR_RED_BACKWARD;
         }
         if (game->current_player == 1 && row_diff >= 0) {  // Black moves down
-            printf("Regular black pieces must move forward (down)!\n");
-            return 0;
+            return MOVE_ERROR_BLACK_BACKWARD;
         }
     }
     
-    // Check if it's a simple move (1 square diagonally)
-    if (abs(row_diff) == 1 && col_diff == 1) {
-        // Simple move - just move the piece
-        MovePiece(game, from_pos, to_pos);
-        return 1;
+    // Only moves produced by the generator are legal
+    MoveList legal;
+    GenerateMoves(game, &legal);
+    int matches;
+    const Move* move = FindMove(&legal, from_pos, to_pos, &matches);
+    if (move != NULL) {
+        int played = ExecuteMove(game, move);
+        if (events != NULL) *events = played;
+        return MOVE_OK;
     }
+    if (matches > 1) return MOVE_ERROR_AMBIGUOUS_JUMP;
+    
+    int has_capture = legal.count > 0 && legal.moves[0].captured != 0ULL;
     
-    // Check if it's a capture move (2 squares diagonally)
+    // Check if it's a single jump (2 squares diagonally)
     if (abs(row_diff) == 2 && col_diff == 2) {
-        // Calculate middle position (the captured piece)
-        int mid_row = (from_row + to_row) / 2;
-        int mid_col = (from_col + to_col) / 2;
-        int mid_pos = GetPosition(mid_row, mid_col);
-        
-        // Check if there's an opponent piece to capture
-        if (!IsOpponentPiece(game, mid_pos)) {
-            printf("No opponent piece to capture!\n");
-            return 0;
-        }
-        
-        // Perform capture
-        CapturePiece(game, from_pos, to_pos, mid_pos);
-        return 1;
+        int mid_pos = GetPosition((from_row + to_row) / 2, (from_col + to_col) / 2);
+        return IsOpponentPiece(game, mid_pos) ? MOVE_ERROR_INCOMPLETE_JUMP : MOVE_ERROR_NO_CAPTURE;
+    }
+    
+    return has_capture ? MOVE_ERROR_CAPTURE_REQUIRED : MOVE_ERROR_INVALID_MOVE;
+}
+
+/**
+ * Finds the leg-by-leg route of a capture sequence
+ * @param move Capture sequence being traced
+ * @param forward Row direction a man jumps in (0 for kings)
+ * @param square Square the jumping piece currently stands on
+ * @param remaining Captured pieces not yet jumped
+ * @param empty Squares the jumping piece may land on
+ * @param landings Output: landing square of each leg
+ * @param victims Output: jumped square of each leg
+ * @param leg Index of the leg being searched
+ * @return Number of legs if a route was found, 0 otherwise
+ */
+static int FindJumpRoute(const Move* move, int forward, int square, unsigned long long remaining,
+                         unsigned long long empty, int* landings, int* victims, int leg) {
+    if (remaining == 0ULL) {
+        return square == move->to ? leg : 0;
     }
     
-    printf("Invalid move! Pieces move diagonally 1 or 2 squares.\n");
+    int row = square / 8;
+    int col = square % 8;
+    for (int dr = -1; dr <= 1; dr += 2) {
+        if (forward != 0 && dr != forward) continue;  // Men only jump forward
+        for (int dc = -1; dc <= 1; dc += 2) {
+            if (!IsValidPosition(row + 2 * dr, col + 2 * dc)) continue;
+            int victim = GetPosition(row + dr, col + dc);
+            int landing = GetPosition(row + 2 * dr, col + 2 * dc);
+            if (!GetBit(remaining, victim) || !GetBit(empty, landing)) continue;
+            
+            landings[leg] = landing;
+            victims[leg] = victim;
+            int legs = FindJumpRoute(move, forward, landing, ClearBit(remaining, victim), empty,
+                                     landings, victims, leg + 1);
+            if (legs) return legs;
+        }
+    }
     return 0;
 }
 
+/**
+ * Plays a generated move one step at a time through MovePiece/CapturePiece
+ * @param game Pointer to game state
+ * @param move Legal move for the current player
+ * @return EVENT_* flags for everything that happened
+ */
+int ExecuteMove(GameState* game, const Move* move) {
+    STATS_INC(STAT_MOVES_MADE);
+    if (move->captured == 0ULL) {
+        return MovePiece(game, move->from, move->to);
+    }
+    
+    unsigned long long all_pieces = game->red_pieces | game->red_kings |
+                                    game->black_pieces | game->black_kings;
+    unsigned long long empty = (PLAYABLE_SQUARES & ~all_pieces) | (1ULL << move->from);
+    int forward = (move->flags & MOVE_KING) ? 0 : (game->current_player == 0 ? 1 : -1);
+    int landings[32];
+    int victims[32];
+    int legs = FindJumpRoute(move, forward, move->from, move->captured, empty,
+                             landings, victims, 0);
+    
+    int events = 0;
+    int square = move->from;
+    for (int i = 0; i < legs; i++) {
+        events |= CapturePiece(game, square, landings[i], victims[i]);
+        square = landings[i];
+    }
+    return events;
+}
+
 // Moves a piece from one position to another
-void MovePiece(GameState* game, int from_pos, int to_pos) {
+// Returns EVENT_PROMOTION if the piece was crowned
+int MovePiece(GameState* game, int from_pos, int to_pos) {
     int is_king_piece = IsKing(game, from_pos);
     
     if (game->current_player == 0) {  // Red
+        int kind = is_king_piece ? ZOBRIST_RED_KING : ZOBRIST_RED_MAN;
         if (is_king_piece) {
             game->red_kings = ClearBit(game->red_kings, from_pos);
             game->red_kings = SetBit(game->red_kings, to_pos);
@@ -142,14 +207,18 @@ void MovePiece(GameState* game, int from_pos, int to_pos) {
             game->red_pieces = ClearBit(game->red_pieces, from_pos);
             game->red_pieces = SetBit(game->red_pieces, to_pos);
         }
+        game->hash ^= ZOBRIST_KEYS[kind][from_pos] ^ ZOBRIST_KEYS[kind][to_pos];
         
         // Check for king promotion (reaching row 7)
         if (to_pos >= 56 && !is_king_piece) {
             game->red_pieces = ClearBit(game->red_pieces, to_pos);
             game->red_kings = SetBit(game->red_kings, to_pos);
-            printf("🎉 Red piece promoted to KING! 🎉\n");
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_RED_MAN][to_pos] ^ ZOBRIST_KEYS[ZOBRIST_RED_KING][to_pos];
+            STATS_INC(STAT_PROMOTIONS);
+            return EVENT_PROMOTION;
         }
     } else {  // Black
+        int kind = is_king_piece ? ZOBRIST_BLACK_KING : ZOBRIST_BLACK_MAN;
         if (is_king_piece) {
             game->black_kings = ClearBit(game->black_kings, from_pos);
             game->black_kings = SetBit(game->black_kings, to_pos);
@@ -157,80 +226,99 @@ void MovePiece(GameState* game, int from_pos, int to_pos) {
             game->black_pieces = ClearBit(game->black_pieces, from_pos);
             game->black_pieces = SetBit(game->black_pieces, to_pos);
         }
+        game->hash ^= ZOBRIST_KEYS[kind][from_pos] ^ ZOBRIST_KEYS[kind][to_pos];
         
         // Check for king promotion (reaching row 0)
         if (to_pos < 8 && !is_king_piece) {
             game->black_pieces = ClearBit(game->black_pieces, to_pos);
             game->black_kings = SetBit(game->black_kings, to_pos);
-            printf("🎉 Black piece promoted to KING! 🎉\n");
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_BLACK_MAN][to_pos] ^ ZOBRIST_KEYS[ZOBRIST_BLACK_KING][to_pos];
+            STATS_INC(STAT_PROMOTIONS);
+            return EVENT_PROMOTION;
         }
     }
+    return 0;
 }
 
 // Captures an opponent piece
-void CapturePiece(GameState* game, int from_pos, int to_pos, int capture_pos) {
+// Returns EVENT_CAPTURE, plus EVENT_PROMOTION if the capturing piece was crowned
+int CapturePiece(GameState* game, int from_pos, int to_pos, int capture_pos) {
     // Remove the captured piece
     if (game->current_player == 0) {  // Red capturing black
+        if (GetBit(game->black_kings, capture_pos)) {
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_BLACK_KING][capture_pos];
+        } else if (GetBit(game->black_pieces, capture_pos)) {
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_BLACK_MAN][capture_pos];
+        }
         game->black_pieces = ClearBit(game->black_pieces, capture_pos);
         game->black_kings = ClearBit(game->black_kings, capture_pos);
     } else {  // Black capturing red
+        if (GetBit(game->red_kings, capture_pos)) {
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_RED_KING][capture_pos];
+        } else if (GetBit(game->red_pieces, capture_pos)) {
+            game->hash ^= ZOBRIST_KEYS[ZOBRIST_RED_MAN][capture_pos];
+        }
         game->red_pieces = ClearBit(game->red_pieces, capture_pos);
         game->red_kings = ClearBit(game->red_kings, capture_pos);
     }
     
-    // Move the capturing piece
-    MovePiece(game, from_pos, to_pos);
+    STATS_INC(STAT_PIECES_CAPTURED);
     
-    printf("💥 Piece captured! 💥\n");
+    // Move the capturing piece
+    return EVENT_CAPTURE | MovePiece(game, from_pos, to_pos);
 }
 
-// Checks if the current player has won
-int CheckWinCondition(GameState* game) {
+/**
+ * Checks whether the player who just moved has won or the game is drawn
+ * A side loses when it has no pieces left or no legal move on its turn; with
+ * a history, a threefold repetition or DRAW_QUIET_PLIES plies without a
+ * capture or man move draw the game.
+ * @param game Pointer to game state (before SwitchPlayer)
+ * @param history The game's moves including the last one, or NULL to skip the draw rules
+ * @return RESULT_NONE, the winner or RESULT_DRAW (game_over is set)
+ */
+GameResult CheckWinCondition(GameState* game, const GameHistory* history) {
     int red_count = CountBits(game->red_pieces | game->red_kings);
     int black_count = CountBits(game->black_pieces | game->black_kings);
     
     if (red_count == 0) {
-        printf("\n");
-        printf("  ╔═══════════════════════════════════════╗\n");
-        printf("  ║                                       ║\n");
-        printf("  ║          🏆 BLACK WINS! 🏆           ║\n");
-        printf("  ║                                       ║\n");
-        printf("  ║      CONGRATULATIONS BLACK PLAYER!    ║\n");
-        printf("  ║                                       ║\n");
-        printf("  ╚═══════════════════════════════════════╝\n");
-        printf("\n");
         game->game_over = 1;
-        return 1;
+        return RESULT_BLACK_WINS;
     }
     
     if (black_count == 0) {
-        printf("\n");
-        printf("  ╔═══════════════════════════════════════╗\n");
-        printf("  ║                                       ║\n");
-        printf("  ║           🏆 RED WINS! 🏆            ║\n");
-        printf("  ║                                       ║\n");
-        printf("  ║       CONGRATULATIONS RED PLAYER!     ║\n");
-        printf("  ║                                       ║\n");
-        printf("  ╚═══════════════════════════════════════╝\n");
-        printf("\n");
         game->game_over = 1;
-        return 1;
+        return RESULT_RED_WINS;
     }
     
-    return 0;
+    // The opponent is next to move: they lose if they are blocked
+    GameState next = *game;
+    next.current_player = 1 - game->current_player;
+    MoveList replies;
+    if (GenerateMoves(&next, &replies) == 0) {
+        game->game_over = 1;
+        return game->current_player == 0 ? RESULT_RED_WINS : RESULT_BLACK_WINS;
+    }
+    
+    if (history != NULL && HistoryIsDraw(history)) {
+        game->game_over = 1;
+        return RESULT_DRAW;
+    }
+    
+    return RESULT_NONE;
 }
 
 // Switches to the other player
 void SwitchPlayer(GameState* game) {
     game->current_player = 1 - game->current_player;
+    game->hash ^= ZOBRIST_BLACK_TO_MOVE;
 }
 
 // Saves the current game state to a file
-int SaveGame(GameState* game, const char* filename) {
+FileStatus SaveGame(GameState* game, const char* filename) {
     FILE* file = fopen(filename, "w");
     if (file == NULL) {
-        printf("Error: Could not open file for saving!\n");
-        return 0;
+        return FILE_ERROR_OPEN;
     }
     
     // Write header
@@ -246,18 +334,17 @@ int SaveGame(GameState* game, const char* filename) {
     fprintf(file, "GAME_OVER=%d\n", game->game_over);
     
     fclose(file);
-    printf("✓ Game saved successfully to '%s'\n", filename);
-    return 1;
+    return FILE_OK;
 }
 
-// Loads a game state from a file
-int LoadGame(GameState* game, const char* filename) {
+// Loads a game state from a file (game is left untouched on failure)
+FileStatus LoadGame(GameState* game, const char* filename) {
     FILE* file = fopen(filename, "r");
     if (file == NULL) {
-        printf("Error: Could not open file for loading!\n");
-        return 0;
+        return FILE_ERROR_OPEN;
     }
     
+    GameState loaded = *game;
     char line[256];
     int loaded_fields = 0;
     
@@ -266,28 +353,33 @@ int LoadGame(GameState* game, const char* filename) {
         if (line[0] == '#' || line[0] == '\n') continue;
         
         // Parse each field
-        if (sscanf(line, "RED_PIECES=%llX", &game->red_pieces) == 1) {
+        if (sscanf(line, "RED_PIECES=%llX", &loaded.red_pieces) == 1) {
             loaded_fields++;
-        } else if (sscanf(line, "RED_KINGS=%llX", &game->red_kings) == 1) {
+        } else if (sscanf(line, "RED_KINGS=%llX", &loaded.red_kings) == 1) {
             loaded_fields++;
-        } else if (sscanf(line, "BLACK_PIECES=%llX", &game->black_pieces) == 1) {
+        } else if (sscanf(line, "BLACK_PIECES=%llX", &loaded.black_pieces) == 1) {
             loaded_fields++;
-        } else if (sscanf(line, "BLACK_KINGS=%llX", &game->black_kings) == 1) {
+        } else if (sscanf(line, "BLACK_KINGS=%llX", &loaded.black_kings) == 1) {
             loaded_fields++;
-        } else if (sscanf(line, "CURRENT_PLAYER=%d", &game->current_player) == 1) {
+        } else if (sscanf(line, "CURRENT_PLAYER=%d", &loaded.current_player) == 1) {
             loaded_fields++;
-        } else if (sscanf(line, "GAME_OVER=%d", &game->game_over) == 1) {
+        } else if (sscanf(line, "GAME_OVER=%d", &loaded.game_over) == 1) {
             loaded_fields++;
         }
     }
     
     fclose(file);
     
-    if (loaded_fields == 6) {
-        printf("✓ Game loaded successfully from '%s'\n", filename);
-        return 1;
-    } else {
-        printf("Error: Invalid save file format!\n");
-        return 0;
+    if (loaded_fields != 6) {
+        return FILE_ERROR_FORMAT;
+    }
+    // An edited or damaged file must not reach move generation with
+    // overlapping boards or pieces on light squares
+    if (!IsValidSetup(&loaded)) {
+        return FILE_ERROR_POSITION;
     }
-}
\ No newline at end of file
+    
+    loaded.hash = ComputeHash(&loaded);
+    *game = loaded;
+    return FILE_OK;
+}
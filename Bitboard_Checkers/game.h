@@ -2,6 +2,44 @@
 #define GAME_H
 
 #include "board.h"
+#include "history.h"
+#include "movegen.h"
+
+// Why MakeMove rejected a move
+typedef enum {
+    MOVE_OK = 0,
+    MOVE_ERROR_INVALID_POSITION,        // Off the board or on a light square
+    MOVE_ERROR_NOT_OWN_PIECE,           // No piece of the side to move on the start square
+    MOVE_ERROR_DESTINATION_OCCUPIED,
+    MOVE_ERROR_RED_BACKWARD,            // Red man moving down
+    MOVE_ERROR_BLACK_BACKWARD,          // Black man moving up
+    MOVE_ERROR_NO_CAPTURE,              // Two-square move without an opponent to jump
+    MOVE_ERROR_INCOMPLETE_JUMP,         // First jump of a longer sequence
+    MOVE_ERROR_CAPTURE_REQUIRED,        // Plain move while a capture is available
+    MOVE_ERROR_AMBIGUOUS_JUMP,          // Several capture sequences join the two squares
+    MOVE_ERROR_INVALID_MOVE             // Anything else
+} MoveStatus;
+
+// Outcome reported by CheckWinCondition (non-zero once the game is over)
+typedef enum {
+    RESULT_NONE = 0,
+    RESULT_RED_WINS,
+    RESULT_BLACK_WINS,
+    RESULT_DRAW                         // Repetition, quiet-move rule or an adjudicated move limit
+} GameResult;
+
+// Result of SaveGame/LoadGame and the binary archive functions
+typedef enum {
+    FILE_OK = 0,
+    FILE_ERROR_OPEN,                    // File could not be opened
+    FILE_ERROR_FORMAT,                  // Missing or malformed fields
+    FILE_ERROR_POSITION,                // Fields read, but pieces overlap or stand on light squares
+    FILE_ERROR_WRITE                    // Data could not be written out
+} FileStatus;
+
+// Events returned by the state-changing functions
+#define EVENT_PROMOTION 0x01            // A man was crowned
+#define EVENT_CAPTURE   0x02            // At least one piece was captured
 
 // Helper functions
 int IsOwnPiece(GameState* game, int position);
@@ -10,14 +48,15 @@ int IsEmpty(GameState* game, int position);
 int IsKing(GameState* game, int position);
 
 // Game logic functions
-int MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col);
-void MovePiece(GameState* game, int from_pos, int to_pos);
-void CapturePiece(GameState* game, int from_pos, int to_pos, int capture_pos);
-int CheckWinCondition(GameState* game);
+MoveStatus MakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col, int* events);
+int ExecuteMove(GameState* game, const Move* move);
+int MovePiece(GameState* game, int from_pos, int to_pos);
+int CapturePiece(GameState* game, int from_pos, int to_pos, int capture_pos);
+GameResult CheckWinCondition(GameState* game, const GameHistory* history);
 void SwitchPlayer(GameState* game);
 
 // Save/Load functionality
-int SaveGame(GameState* game, const char* filename);
-int LoadGame(GameState* game, const char* filename);
+FileStatus SaveGame(GameState* game, const char* filename);
+FileStatus LoadGame(GameState* game, const char* filename);
 
 #endif // GAME_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <string.h>
+#include "history.h"
+#include "zobrist.h"
+
+#define RING_SLOT(ply) ((ply) & (HISTORY_RING - 1))
+
+// Starts an empty history at game
+void HistoryStart(GameHistory* history, const GameState* game) {
+    history->position = *game;
+    history->position.hash = ComputeHash(game);
+    history->keys[RING_SLOT(0)] = history->position.hash;
+    history->quiet_plies[RING_SLOT(0)] = 0;
+    history->ply = 0;
+    history->end = 0;
+}
+
+/**
+ * Plays a move of the current position
+ * Moves that were taken back and not redone are dropped; moves more than
+ * HISTORY_UNDO_PLIES back are forgotten and can no longer be taken back.
+ * @param history Game history
+ * @param move Legal move of history->position
+ */
+void HistoryAddMove(GameHistory* history, const Move* move) {
+    int ply = history->ply;
+    history->moves[RING_SLOT(ply)] = *move;
+    DoMove(&history->position, move);
+    history->keys[RING_SLOT(ply + 1)] = history->position.hash;
+    int irreversible = move->captured != 0ULL || !(move->flags & MOVE_KING);
+    int quiet = history->quiet_plies[RING_SLOT(ply)] + 1;
+    history->quiet_plies[RING_SLOT(ply + 1)] = irreversible ? 0 : (quiet < 0xFFFF ? quiet : 0xFFFF);
+    history->ply = ply + 1;
+    history->end = ply + 1;
+}
+
+// Takes back the last move and copies the position into game; returns 0 at the
+// start, or when the ring would no longer hold a full quiet stretch before it
+int HistoryUndo(GameHistory* history, GameState* game) {
+    if (history->ply == 0 || history->end - (history->ply - 1) > HISTORY_UNDO_PLIES) return 0;
+    history->ply--;
+    UndoMove(&history->position, &history->moves[RING_SLOT(history->ply)]);
+    *game = history->position;
+    return 1;
+}
+
+// Plays the last move taken back again and copies the position into game; returns 0 if there is none
+int HistoryRedo(GameHistory* history, GameState* game) {
+    if (history->ply == history->end) return 0;
+    DoMove(&history->position, &history->moves[RING_SLOT(history->ply)]);
+    history->ply++;
+    *game = history->position;
+    return 1;
+}
+
+// Returns the key of the position after ply moves; ply must be one of the
+// last HISTORY_RING positions up to history->end
+unsigned long long HistoryKey(const GameHistory* history, int ply) {
+    return history->keys[RING_SLOT(ply)];
+}
+
+// Returns how often the current position occurred before (same side to move)
+int HistoryRepetitions(const GameHistory* history) {
+    int ply = history->ply;
+    unsigned long long key = history->keys[RING_SLOT(ply)];
+    // Only the quiet stretch can hold a repetition, and only the ring holds keys
+    int reach = history->quiet_plies[RING_SLOT(ply)];
+    int kept = HISTORY_RING - 1 - (history->end - ply);
+    if (reach > kept) reach = kept;
+    int count = 0;
+    for (int back = 4; back <= reach; back += 2) {
+        count += history->keys[RING_SLOT(ply - back)] == key;
+    }
+    return count;
+}
+
+// Returns the plies played since the last capture or man move
+int HistoryQuietPlies(const GameHistory* history) {
+    return history->quiet_plies[RING_SLOT(history->ply)];
+}
+
+// Returns 1 if the current position is drawn by repetition or the quiet-move rule
+int HistoryIsDraw(const GameHistory* history) {
+    return HistoryRepetitions(history) >= DRAW_REPETITIONS - 1 ||
+           HistoryQuietPlies(history) >= DRAW_QUIET_PLIES;
+}
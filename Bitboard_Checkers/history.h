@@ -0,0 +1,44 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "board.h"
+#include "movegen.h"
+
+// Draw rules: the same position with the same side to move for the third
+// time, or this many plies (40 moves each) without a capture or a man moving
+#define DRAW_REPETITIONS 3
+#define DRAW_QUIET_PLIES 80
+
+// Plies the history remembers (a power of two). Every position keeps the
+// DRAW_QUIET_PLIES keys before it for the repetition checks, which leaves
+// HISTORY_UNDO_PLIES moves that can be taken back.
+#define HISTORY_RING 256
+#define HISTORY_UNDO_PLIES (HISTORY_RING - 1 - DRAW_QUIET_PLIES)
+
+// Moves of one game with the key of every position reached, in ring buffers
+// indexed by ply, so games of any length fit. Captures and man moves cannot
+// be taken back, so a position can only repeat within the quiet stretch
+// since the last of them; repetition checks never look further back.
+typedef struct {
+    GameState position;                                 // Position after the moves played
+    Move moves[HISTORY_RING];                           // moves[i % HISTORY_RING] = move i
+    unsigned long long keys[HISTORY_RING];              // keys[i % HISTORY_RING] = position before move i
+    unsigned short quiet_plies[HISTORY_RING];           // Plies since a capture or man move, per position
+    int ply;                                            // Moves played
+    int end;                                            // Moves that can be redone run up to here
+} GameHistory;
+
+void HistoryStart(GameHistory* history, const GameState* game);
+void HistoryAddMove(GameHistory* history, const Move* move);
+int HistoryUndo(GameHistory* history, GameState* game);
+int HistoryRedo(GameHistory* history, GameState* game);
+
+// Key of the position after ply moves (one of the last HISTORY_RING)
+unsigned long long HistoryKey(const GameHistory* history, int ply);
+
+// Draw rules for the current position
+int HistoryRepetitions(const GameHistory* history);
+int HistoryQuietPlies(const GameHistory* history);
+int HistoryIsDraw(const GameHistory* history);
+
+#endif // HISTORY_H
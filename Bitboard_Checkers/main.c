@@ -1,16 +1,220 @@
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include "archive.h"
 #include "bitops.h"
 #include "board.h"
+#include "book.h"
 #include "game.h"
+#include "history.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "notation.h"
+#include "protocol.h"
+#include "search.h"
+#include "stats.h"
+#include "tablebase.h"
+#include "tt.h"
+#include "ui.h"
 
-int main() {
+// Default thinking time for the computer player
+#define DEFAULT_ENGINE_TIME_MS 2000
+
+// Endgame databases picked up automatically when present
+#define DEFAULT_TABLEBASE_DIR "tablebase"
+
+// Evaluation network picked up automatically when present
+#define DEFAULT_NETWORK_FILE "checkers.nnue"
+
+// Opening book picked up automatically when present
+#define DEFAULT_BOOK_FILE "checkers.book"
+
+// Binary saves (with move history) are told apart from text saves by extension
+#define BINARY_SAVE_EXTENSION ".ckb"
+
+// Returns 1 if filename ends with the binary save extension
+static int IsBinarySave(const char* filename) {
+    size_t length = strlen(filename);
+    size_t extension = strlen(BINARY_SAVE_EXTENSION);
+    return length > extension && strcmp(filename + length - extension, BINARY_SAVE_EXTENSION) == 0;
+}
+
+// Background search of the position after the computer's move and the reply
+// it expects, run while the human thinks
+typedef struct {
+    pthread_t thread;
+    int active;                         // Thread started and not yet joined
+    int done;                           // Search finished (under ponder_lock)
+    int hit;                            // The human played the expected reply
+    GameState position;                 // Position being searched
+    GameHistory history;                // The game up to that position
+    Move expected;                      // Human move the search assumes
+    SearchResult result;
+    double start;
+} Ponder;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Signalled by the ponder thread when its search ends
+static pthread_mutex_t ponder_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ponder_finished = PTHREAD_COND_INITIALIZER;
+
+static void* PonderThread(void* arg) {
+    Ponder* ponder = arg;
+    SearchLimits limits = { 0, 0, 0, 1, NULL, NULL, &ponder->history };
+    SearchBestMove(&ponder->position, &limits, &ponder->result);
+    pthread_mutex_lock(&ponder_lock);
+    ponder->done = 1;
+    pthread_cond_signal(&ponder_finished);
+    pthread_mutex_unlock(&ponder_lock);
+    return NULL;
+}
+
+// Starts pondering the position after the computer's move, if its search predicted a reply
+static void StartPonder(Ponder* ponder, const GameHistory* history, const SearchResult* result) {
+    if (result->pv_length < 2) return;
+
+    ponder->history = *history;
+    HistoryAddMove(&ponder->history, &result->pv[1]);
+    ponder->position = ponder->history.position;
+    ponder->expected = result->pv[1];
+    ponder->done = 0;
+    ponder->hit = 0;
+    ponder->start = Now();
+    ponder->active = pthread_create(&ponder->thread, NULL, PonderThread, ponder) == 0;
+}
+
+// Waits for the ponder search, stopping it at deadline (0 = at once)
+static void FinishPonder(Ponder* ponder, double deadline) {
+    if (!ponder->active) return;
+
+    // Let the search run on until the deadline unless it finishes first
+    double remaining = deadline - Now();
+    if (remaining > 0) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        long long nanoseconds = until.tv_nsec + (long long)(remaining * 1e9);
+        until.tv_sec += nanoseconds / 1000000000;
+        until.tv_nsec = nanoseconds % 1000000000;
+
+        pthread_mutex_lock(&ponder_lock);
+        while (!ponder->done) {
+            if (pthread_cond_timedwait(&ponder_finished, &ponder_lock, &until) == ETIMEDOUT) break;
+        }
+        pthread_mutex_unlock(&ponder_lock);
+    }
+
+    StopSearch();
+    pthread_join(ponder->thread, NULL);
+    ClearStopSearch();
+    ponder->active = 0;
+}
+
+// Abandons pondering (its transposition table entries stay useful)
+static void StopPonder(Ponder* ponder) {
+    FinishPonder(ponder, 0);
+    ponder->hit = 0;
+}
+
+// Longest jump sequence that can be typed in, end squares included
+#define MAX_PATH_SQUARES 16
+
+// Reads the squares of a typed move as row/column pairs and writes them in
+// protocol notation ("21-32", left empty if a square is off the board);
+// returns how many there are, 0 unless the input is 2 to MAX_PATH_SQUARES squares
+static int ReadPath(const char* input, int* rows, int* cols, char* notation) {
+    int count = 0, on_board = 1, length;
+    while (count < MAX_PATH_SQUARES && sscanf(input, "%d %d%n", &rows[count], &cols[count], &length) == 2) {
+        if (!IsValidPosition(rows[count], cols[count])) on_board = 0;
+        count++;
+        input += length;
+    }
+    if (count < 2 || input[strspn(input, " ")] != '\0') return 0;
+
+    notation[0] = '\0';
+    for (int i = 0; on_board && i < count; i++) {
+        sprintf(notation + strlen(notation), i > 0 ? "-%d%d" : "%d%d", rows[i], cols[i]);
+    }
+    return count;
+}
+
+// Lets the engine pick and play a move for the current player
+// A ponder hit continues the ponder search until time_ms after it started
+// Returns 1 if a move was played, 0 if the current player has no legal moves
+static int PlayComputerMove(GameState* game, GameRecord* record, GameHistory* history, int time_ms,
+                            Ponder* ponder, SearchResult* searched) {
+    SearchLimits limits = { 0, time_ms, 0, 1, NULL, NULL, history };
+    SearchResult result;
+    int ponder_hit = ponder->active && ponder->hit;
+    
+    printf("\n%s (computer) is thinking...\n", game->current_player == 0 ? "RED" : "BLACK");
+    if (ponder_hit) {
+        FinishPonder(ponder, ponder->start + time_ms / 1000.0);
+        ponder->hit = 0;
+        result = ponder->result;
+        if (!result.has_move) return 0;
+    } else if (!SearchBestMove(game, &limits, &result)) {
+        return 0;
+    }
+    
+    *searched = result;
+    const Move* move = &result.best_move;
+    HistoryAddMove(history, move);
+    if (result.from_book) {
+        printf("Computer plays %d %d -> %d %d  (opening book)\n",
+               move->from / 8, move->from % 8, move->to / 8, move->to % 8);
+        RecordAddMove(record, move);
+        UIExecuteMove(game, move);
+        return 1;
+    }
+    printf("Computer plays %d %d -> %d %d  (depth %d, score %+d, %llu nodes, %.0f nodes/sec%s)\n",
+           move->from / 8, move->from % 8, move->to / 8, move->to % 8,
+           result.depth, result.score, result.nodes,
+           result.elapsed > 0 ? result.nodes / result.elapsed : 0.0,
+           ponder_hit ? ", ponder hit" : "");
+    RecordAddMove(record, move);
+    UIExecuteMove(game, move);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+    
+    // Engine protocol for GUIs and tournament managers instead of the prompt
+    if (argc > 1 && strcmp(argv[1], "--protocol") == 0) {
+        TTInit(TT_DEFAULT_MB);
+        TBInit(DEFAULT_TABLEBASE_DIR);
+        NNUELoad(DEFAULT_NETWORK_FILE);
+        BookInit(DEFAULT_BOOK_FILE);
+        return RunProtocol();
+    }
     
     printf("Press Enter to start the game...");
     getchar();
     
     GameState game;
     InitializeGame(&game);
+    GameRecord record;
+    RecordStart(&record, &game);
+    GameHistory history;
+    HistoryStart(&history, &game);
+    
+    int computer_player = -1;  // -1 = none, 0 = Red, 1 = Black
+    int engine_time_ms = DEFAULT_ENGINE_TIME_MS;
+    int pondering = 1;
+    Ponder ponder;
+    memset(&ponder, 0, sizeof(ponder));
+    TTInit(TT_DEFAULT_MB);
+    TBInit(DEFAULT_TABLEBASE_DIR);
+    NNUELoad(DEFAULT_NETWORK_FILE);
+    BookInit(DEFAULT_BOOK_FILE);
     
     printf("\n╔═══════════════════════════════════════╗\n");
     printf("║  WELCOME TO BITBOARD CHECKERS!       ║\n");
@@ -21,13 +225,53 @@ int main() {
     printf("║                                       ║\n");
     printf("║  Commands:                            ║\n");
     printf("║  - Move: row col row col              ║\n");
+    printf("║    (a jump may list every landing)    ║\n");
     printf("║  - Save: save <filename>.sav              ║\n");
     printf("║  - Load: load <filename>.sav              ║\n");
+    printf("║  - Archive: archive <file>            ║\n");
+    printf("║  - Replay: replay <file> <game>       ║\n");
+    printf("║  - Take back: undo / redo             ║\n");
+    printf("║  - Engine: computer red|black|off     ║\n");
+    printf("║  - Engine time: time <ms>             ║\n");
+    printf("║  - Engine memory: hash <MB>           ║\n");
+    printf("║  - Engine threads: threads <n>        ║\n");
+    printf("║  - Pondering: ponder on|off           ║\n");
+    printf("║  - Endgames: tablebase <dir>          ║\n");
+    printf("║  - Evaluation: nnue <file>|off        ║\n");
+    printf("║  - Openings: book <file>|off          ║\n");
+    printf("║  - Counters: stats [reset]            ║\n");
     printf("║  - Quit: quit                         ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
     while (!game.game_over) {
         DisplayBoard(&game);
+        UIReportTablebase(&game);
+        UIReportBook(&game);
+        
+        // Computer's turn
+        if (game.current_player == computer_player) {
+            SearchResult searched;
+            int played = PlayComputerMove(&game, &record, &history, engine_time_ms, &ponder, &searched);
+            if (played == 0) {
+                printf("%s has no legal moves left!\n", game.current_player == 0 ? "RED" : "BLACK");
+                record.result = game.current_player == 0 ? RESULT_BLACK_WINS : RESULT_RED_WINS;
+                game.game_over = 1;
+                break;
+            }
+            GameResult result = UICheckWinCondition(&game, &history);
+            if (result != RESULT_NONE) {
+                record.result = result;
+                DisplayBoard(&game);
+                break;
+            }
+            SwitchPlayer(&game);
+            
+            // Search the expected reply while the human thinks
+            if (pondering && computer_player != game.current_player) {
+                StartPonder(&ponder, &history, &searched);
+            }
+            continue;
+        }
         
         char input[100];
         int from_row, from_col, to_row, to_col;
@@ -40,6 +284,12 @@ int main() {
         // Remove newline
         input[strcspn(input, "\n")] = 0;
         
+        // Commands (save, load, quit, engine settings...) end pondering first;
+        // a move is checked against the expected reply once it is played
+        if (sscanf(input, "%d %d %d %d", &from_row, &from_col, &to_row, &to_col) != 4) {
+            StopPonder(&ponder);
+        }
+        
         // Check for quit command
         if (strcmp(input, "quit") == 0) {
             printf("Thanks for playing!\n");
@@ -49,8 +299,10 @@ int main() {
         // Check for save command
         if (strncmp(input, "save ", 5) == 0) {
             char* filename = input + 5;
-            if (strlen(filename) > 0) {
-                SaveGame(&game, filename);
+            if (IsBinarySave(filename)) {
+                UISaveRecord(&record, filename);
+            } else if (strlen(filename) > 0) {
+                UISaveGame(&game, filename);
             } else {
                 printf("Usage: save <filename>\n");
             }
@@ -60,8 +312,15 @@ int main() {
         // Check for load command
         if (strncmp(input, "load ", 5) == 0) {
             char* filename = input + 5;
-            if (strlen(filename) > 0) {
-                if (LoadGame(&game, filename)) {
+            if (IsBinarySave(filename)) {
+                if (UILoadRecord(&game, &record, filename)) {
+                    record.ply_count = RecordHistory(&record, &history);
+                    printf("Game loaded! Resuming play...\n");
+                }
+            } else if (strlen(filename) > 0) {
+                if (UILoadGame(&game, filename)) {
+                    RecordStart(&record, &game);
+                    HistoryStart(&history, &game);
                     printf("Game loaded! Resuming play...\n");
                 }
             } else {
@@ -70,17 +329,203 @@ int main() {
             continue;
         }
         
-        // Parse the input
-        if (sscanf(input, "%d %d %d %d", &from_row, &from_col, &to_row, &to_col) != 4) {
+        // Check for archive command (append this game to a multi-game file)
+        if (strncmp(input, "archive ", 8) == 0) {
+            char* path = input + 8;
+            if (strlen(path) > 0) {
+                UIArchiveGame(&record, path);
+            } else {
+                printf("Usage: archive <file>\n");
+            }
+            continue;
+        }
+        
+        // Check for replay command (load a game from an archive)
+        if (strncmp(input, "replay ", 7) == 0) {
+            char path[100];
+            unsigned long long number;
+            if (sscanf(input + 7, "%99s %llu", path, &number) == 2) {
+                if (UIReplayGame(&game, &record, path, number)) {
+                    record.ply_count = RecordHistory(&record, &history);
+                    printf("Game loaded! Resuming play...\n");
+                }
+            } else {
+                printf("Usage: replay <file> <game number>\n");
+            }
+            continue;
+        }
+        
+        // Check for undo/redo commands; against the computer they step back
+        // (or forward) to your own turn
+        if (strcmp(input, "undo") == 0 || strcmp(input, "redo") == 0) {
+            int undo = strcmp(input, "undo") == 0;
+            int moves = 0;
+            while ((undo ? HistoryUndo(&history, &game) : HistoryRedo(&history, &game)) &&
+                   ++moves < 2 && game.current_player == computer_player) {}
+            if (moves == 0) {
+                printf("Nothing to %s\n", input);
+                continue;
+            }
+            record.ply_count = history.ply;
+            record.result = RESULT_NONE;
+            printf("%s %d move%s\n", undo ? "Took back" : "Replayed", moves, moves == 1 ? "" : "s");
+            continue;
+        }
+        
+        // Check for computer opponent command
+        if (strncmp(input, "computer ", 9) == 0) {
+            char* side = input + 9;
+            if (strcmp(side, "red") == 0) {
+                computer_player = 0;
+            } else if (strcmp(side, "black") == 0) {
+                computer_player = 1;
+            } else if (strcmp(side, "off") == 0) {
+                computer_player = -1;
+            } else {
+                printf("Usage: computer red|black|off\n");
+                continue;
+            }
+            printf("Computer opponent: %s\n", side);
+            continue;
+        }
+        
+        // Check for engine time command
+        if (strncmp(input, "time ", 5) == 0) {
+            int time_ms = atoi(input + 5);
+            if (time_ms > 0) {
+                engine_time_ms = time_ms;
+                printf("Computer thinking time: %d ms\n", engine_time_ms);
+            } else {
+                printf("Usage: time <milliseconds>\n");
+            }
+            continue;
+        }
+        
+        // Check for hash size command
+        if (strncmp(input, "hash ", 5) == 0) {
+            int size_mb = atoi(input + 5);
+            if (size_mb <= 0) {
+                printf("Usage: hash <megabytes>\n");
+            } else if (TTInit(size_mb)) {
+                printf("Hash table: %d MB\n", TTSizeMB());
+            } else {
+                printf("Error: Could not allocate %d MB! Hash table disabled.\n", size_mb);
+            }
+            continue;
+        }
+        
+        // Check for search threads command
+        if (strncmp(input, "threads ", 8) == 0) {
+            int count = atoi(input + 8);
+            if (count > 0 && SetSearchThreads(count)) {
+                printf("Search threads: %d\n", GetSearchThreads());
+            } else {
+                printf("Usage: threads <count>\n");
+            }
+            continue;
+        }
+        
+        // Check for endgame database command
+        if (strncmp(input, "tablebase ", 10) == 0) {
+            char* directory = input + 10;
+            int pieces = TBInit(directory);
+            if (pieces > 0) {
+                printf("Endgame databases: up to %d pieces from '%s'\n", pieces, directory);
+            } else {
+                printf("Error: No endgame databases found in '%s'!\n", directory);
+            }
+            continue;
+        }
+        
+        // Check for evaluation network command
+        if (strncmp(input, "nnue ", 5) == 0) {
+            char* filename = input + 5;
+            if (strcmp(filename, "off") == 0) {
+                NNUEUnload();
+                printf("Evaluation: hand-written terms\n");
+            } else if (strlen(filename) > 0) {
+                UILoadNetwork(filename);
+            } else {
+                printf("Usage: nnue <file>|off\n");
+            }
+            continue;
+        }
+        
+        // Check for pondering command
+        if (strncmp(input, "ponder ", 7) == 0) {
+            char* mode = input + 7;
+            if (strcmp(mode, "on") == 0 || strcmp(mode, "off") == 0) {
+                pondering = strcmp(mode, "on") == 0;
+                printf("Pondering: %s\n", mode);
+            } else {
+                printf("Usage: ponder on|off\n");
+            }
+            continue;
+        }
+        
+        // Check for statistics commands (counters exist in STATS=1 builds)
+        if (strcmp(input, "stats") == 0) {
+            StatsWriteReport(stdout);
+            continue;
+        }
+        if (strcmp(input, "stats reset") == 0) {
+            StatsReset();
+            printf("Statistics cleared\n");
+            continue;
+        }
+        
+        // Check for opening book command
+        if (strncmp(input, "book ", 5) == 0) {
+            char* filename = input + 5;
+            if (strcmp(filename, "off") == 0) {
+                BookClose();
+                printf("Opening book: off\n");
+            } else if (strlen(filename) > 0) {
+                UILoadBook(filename);
+            } else {
+                printf("Usage: book <file>|off\n");
+            }
+            continue;
+        }
+        
+        // Parse the input: the two end squares, or every landing square of a jump sequence
+        int rows[MAX_PATH_SQUARES], cols[MAX_PATH_SQUARES];
+        char notation[3 * MAX_PATH_SQUARES];
+        int squares = ReadPath(input, rows, cols, notation);
+        if (squares == 0) {
             printf("Invalid input! Use format: from_row from_col to_row to_col\n");
             printf("Example: 2 1 3 2\n");
             continue;
         }
         
-        // Try to make the move
-        if (MakeMove(&game, from_row, from_col, to_row, to_col)) {
+        // The generator's move matching the input, for the game record
+        MoveList legal;
+        const Move* played = ParseMove(&game, notation, &legal);
+
+        // Try to make the move; a full jump sequence is either the generator's or rejected
+        int made;
+        if (squares == 2) {
+            made = UIMakeMove(&game, rows[0], cols[0], rows[1], cols[1]);
+        } else if (played != NULL) {
+            UIExecuteMove(&game, played);
+            made = 1;
+        } else {
+            printf("That is not a legal jump sequence!\n");
+            made = 0;
+        }
+        if (made) {
+            RecordAddMove(&record, played);
+            if (played != NULL) HistoryAddMove(&history, played);
+            
+            // Keep the ponder search only if it assumed this move
+            ponder.hit = ponder.active && played != NULL && played->from == ponder.expected.from &&
+                         played->to == ponder.expected.to && played->captured == ponder.expected.captured;
+            if (!ponder.hit) StopPonder(&ponder);
+            
             // Check win condition
-            if (CheckWinCondition(&game)) {
+            GameResult result = UICheckWinCondition(&game, &history);
+            if (result != RESULT_NONE) {
+                record.result = result;
                 DisplayBoard(&game);
                 break;
             }
@@ -92,6 +537,7 @@ int main() {
         }
     }
     
+    StopPonder(&ponder);
     printf("\nGame Over! Thanks for playing BitBoard Checkers!\n");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,677 @@
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "archive.h"
+#include "bitops.h"
+#include "board.h"
+#include "game.h"
+#include "history.h"
+#include "movegen.h"
+#include "notation.h"
+#include "render.h"
+
+/*
+ * Plays two engines against each other through the engine protocol
+ * (protocol.c), so a match can compare two builds: each side is a command
+ * line such as "./checkers --protocol", optionally followed by "set" options.
+ * Every worker runs one game at a time with its own pair of engine processes.
+ * Game 2k and 2k+1 start from the same opening with colours swapped.
+ */
+
+// Games still running after this many plies are adjudicated as draws
+#define DEFAULT_MAX_PLIES 300
+
+// Extra time an engine gets to answer before it loses on time
+#define TIME_MARGIN_MS 1000
+
+// Most "set" commands per engine
+#define MAX_OPTIONS 8
+
+#define LINE_SIZE 8192
+
+// How one side is started and configured
+typedef struct {
+    const char* command;
+    const char* options[MAX_OPTIONS];   // "name value" pairs sent as "set name value"
+    int option_count;
+} EngineConfig;
+
+// A running engine process
+typedef struct {
+    const EngineConfig* config;
+    pid_t pid;
+    int to_engine;
+    int from_engine;
+    char buffer[LINE_SIZE];
+    size_t used;
+} Engine;
+
+// Settings shared by every worker
+typedef struct {
+    EngineConfig engines[2];
+    unsigned long long games;
+    int concurrency;
+    int time_ms;                        // Per-move time (0 = use depth/nodes)
+    int depth;
+    unsigned long long nodes;
+    int max_plies;
+    const char* openings;
+    const char* output;                 // Archive to write, or NULL
+    double elo0, elo1;                  // SPRT hypotheses (elo1 > elo0 when enabled)
+    double alpha, beta;
+    int sprt;
+    int watch_ms;                       // Spectator grid refresh interval (0 = score line only)
+} Settings;
+
+// Score from the first engine's point of view
+typedef struct {
+    unsigned long long wins, draws, losses;
+    unsigned long long forfeits[2];     // Games lost on time, illegal move or crash
+} Score;
+
+static Settings settings;
+static LiveGame* live = NULL;           // One per worker with --watch
+static int workers_done = 0;
+static PositionEntry* openings = NULL;
+static int opening_count = 0;
+static ArchiveWriter writer;
+static int write_failed = 0;
+static unsigned long long next_game = 0;
+static int stop_match = 0;
+
+static pthread_mutex_t score_lock = PTHREAD_MUTEX_INITIALIZER;
+static Score score;
+static double start_time;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Sends one command line; returns 0 if the engine is gone
+static int EngineSend(Engine* engine, const char* format, ...) {
+    char line[LINE_SIZE];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line) - 1, format, args);
+    va_end(args);
+    if (length < 0 || length >= (int)sizeof(line) - 1) return 0;
+    line[length++] = '\n';
+
+    for (int sent = 0; sent < length; ) {
+        ssize_t written = write(engine->to_engine, line + sent, length - sent);
+        if (written <= 0) return 0;
+        sent += written;
+    }
+    return 1;
+}
+
+/**
+ * Reads one reply line
+ * @param engine Engine to read from
+ * @param line Output: the line without its newline
+ * @param deadline Time (Now()) after which to give up
+ * @return 1 on success, 0 on timeout or if the engine is gone
+ */
+static int EngineReadLine(Engine* engine, char* line, double deadline) {
+    for (;;) {
+        char* end = memchr(engine->buffer, '\n', engine->used);
+        if (end != NULL) {
+            size_t length = end - engine->buffer;
+            memcpy(line, engine->buffer, length);
+            line[length] = '\0';
+            if (length > 0 && line[length - 1] == '\r') line[length - 1] = '\0';
+            engine->used -= length + 1;
+            memmove(engine->buffer, end + 1, engine->used);
+            return 1;
+        }
+        if (engine->used == sizeof(engine->buffer) - 1) engine->used = 0;  // Drop an over-long line
+
+        double remaining = deadline - Now();
+        if (remaining <= 0) return 0;
+        struct pollfd output = { engine->from_engine, POLLIN, 0 };
+        if (poll(&output, 1, (int)(remaining * 1000) + 1) <= 0) continue;
+
+        ssize_t received = read(engine->from_engine, engine->buffer + engine->used,
+                                sizeof(engine->buffer) - 1 - engine->used);
+        if (received <= 0) return 0;
+        engine->used += received;
+    }
+}
+
+// Reads until a line starting with reply arrives; returns 0 on timeout or if the engine is gone
+static int EngineWaitFor(Engine* engine, const char* reply, char* line, double deadline) {
+    size_t length = strlen(reply);
+    while (EngineReadLine(engine, line, deadline)) {
+        if (strncmp(line, reply, length) == 0 && (line[length] == '\0' || line[length] == ' ')) return 1;
+    }
+    return 0;
+}
+
+static void EngineStop(Engine* engine) {
+    if (engine->pid <= 0) return;
+    EngineSend(engine, "quit");
+    close(engine->to_engine);
+    close(engine->from_engine);
+
+    // Give it a moment to exit on its own before killing it
+    double deadline = Now() + 1.0;
+    struct timespec interval = { 0, 10000000 };
+    while (waitpid(engine->pid, NULL, WNOHANG) == 0) {
+        if (Now() >= deadline) {
+            kill(engine->pid, SIGKILL);
+            waitpid(engine->pid, NULL, 0);
+            break;
+        }
+        nanosleep(&interval, NULL);
+    }
+    engine->pid = 0;
+}
+
+/**
+ * Starts an engine process and waits until it is configured and ready
+ * @param engine Engine to start (its config must be set)
+ * @return 1 on success, 0 if it could not be started or did not answer
+ */
+static int EngineStart(Engine* engine) {
+    // Workers start engines one at a time so no child inherits another's pipes
+    // (which would hide that engine's exit)
+    static pthread_mutex_t spawn_lock = PTHREAD_MUTEX_INITIALIZER;
+    int to_engine[2], from_engine[2];
+    pthread_mutex_lock(&spawn_lock);
+    if (pipe(to_engine) != 0) {
+        pthread_mutex_unlock(&spawn_lock);
+        return 0;
+    }
+    if (pipe(from_engine) != 0) {
+        close(to_engine[0]);
+        close(to_engine[1]);
+        pthread_mutex_unlock(&spawn_lock);
+        return 0;
+    }
+    fcntl(to_engine[1], F_SETFD, FD_CLOEXEC);
+    fcntl(from_engine[0], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(to_engine[0], STDIN_FILENO);
+        dup2(from_engine[1], STDOUT_FILENO);
+        close(to_engine[0]);
+        close(to_engine[1]);
+        close(from_engine[0]);
+        close(from_engine[1]);
+        execl("/bin/sh", "sh", "-c", engine->config->command, (char*)NULL);
+        _exit(127);
+    }
+    close(to_engine[0]);
+    close(from_engine[1]);
+    pthread_mutex_unlock(&spawn_lock);
+    if (pid < 0) {
+        close(to_engine[1]);
+        close(from_engine[0]);
+        return 0;
+    }
+    engine->pid = pid;
+    engine->to_engine = to_engine[1];
+    engine->from_engine = from_engine[0];
+    engine->used = 0;
+
+    char line[LINE_SIZE];
+    double deadline = Now() + 10.0;
+    int ok = EngineSend(engine, "hello") && EngineWaitFor(engine, "hellook", line, deadline);
+    for (int i = 0; ok && i < engine->config->option_count; i++) {
+        ok = EngineSend(engine, "set %s", engine->config->options[i]);
+    }
+    ok = ok && EngineSend(engine, "isready") && EngineWaitFor(engine, "readyok", line, deadline);
+    if (!ok) EngineStop(engine);
+    return ok;
+}
+
+// Writes a position as the protocol's save-file fields
+static void FormatPosition(const GameState* game, char* text, size_t size) {
+    snprintf(text, size, "RED_PIECES=%016llX RED_KINGS=%016llX BLACK_PIECES=%016llX BLACK_KINGS=%016llX CURRENT_PLAYER=%d",
+             game->red_pieces, game->red_kings, game->black_pieces, game->black_kings, game->current_player);
+}
+
+/**
+ * Asks an engine for its move in the current game
+ * @param engine Engine to move
+ * @param start Start position of the game
+ * @param moves Moves played so far, as protocol text separated by spaces
+ * @param game Current position
+ * @param list Output: legal moves of game (the returned move points into it)
+ * @return The engine's legal move, or NULL if it forfeits (time, illegal move, crash)
+ */
+static const Move* EngineMove(Engine* engine, const char* start, const char* moves,
+                              const GameState* game, MoveList* list) {
+    if (!EngineSend(engine, "position %s moves%s", start, moves)) return NULL;
+
+    double deadline = Now() + TIME_MARGIN_MS / 1000.0;
+    int sent;
+    if (settings.time_ms > 0) {
+        deadline += settings.time_ms / 1000.0;
+        sent = EngineSend(engine, "go time %d", settings.time_ms);
+    } else if (settings.nodes > 0) {
+        deadline += 3600;
+        sent = EngineSend(engine, "go nodes %llu", settings.nodes);
+    } else {
+        deadline += 3600;
+        sent = EngineSend(engine, "go depth %d", settings.depth);
+    }
+
+    char line[LINE_SIZE];
+    if (!sent || !EngineWaitFor(engine, "bestmove", line, deadline)) return NULL;
+    char move[MOVE_TEXT_SIZE];
+    if (sscanf(line, "bestmove %63s", move) != 1) return NULL;
+    return ParseMove(game, move, list);
+}
+
+// Publishes a worker's position to the spectator grid; result is NULL while the game goes on
+static void ShowGame(LiveGame* view, unsigned long long number, const GameState* game, int ply,
+                     const char* result) {
+    char title[64];
+    snprintf(title, sizeof(title), "Game %llu: e%d red", number + 1, (int)(number % 2) + 1);
+    LiveGameShow(view, title, game, ply, result);
+}
+
+/**
+ * Plays one game
+ * Engines are sent the position after the last capture or man move plus the
+ * moves since, which is all they need to see repetitions.
+ * @param number Game number (selects the opening and the colours)
+ * @param engines The worker's engines, indexed by EngineConfig
+ * @param record Output: the game
+ * @param history Worker's scratch history (for the draw rules)
+ * @param view Where the game is shown with --watch, or NULL
+ * @return Result for the first engine: 1 win, 0 draw, -1 loss; *forfeit is
+ *         set to the engine that forfeited (or -1)
+ */
+static int PlayGame(unsigned long long number, Engine* engines, GameRecord* record, GameHistory* history,
+                    LiveGame* view, int* forfeit) {
+    GameState game;
+    if (opening_count > 0) {
+        game = openings[(number / 2) % opening_count].game;
+    } else {
+        InitializeGame(&game);
+    }
+    RecordStart(record, &game);
+    HistoryStart(history, &game);
+
+    char start[256];
+    FormatPosition(&game, start, sizeof(start));
+    char moves[DRAW_QUIET_PLIES * (MOVE_TEXT_SIZE + 1) + 1];
+    size_t moves_length = 0;
+    moves[0] = '\0';
+
+    int red_engine = number % 2;        // Engine playing red (0 = first)
+    *forfeit = -1;
+    EngineSend(&engines[0], "newgame");
+    EngineSend(&engines[1], "newgame");
+
+    MoveList list;
+    for (int ply = 0; ; ply++) {
+        if (view != NULL) ShowGame(view, number, &game, ply, NULL);
+        GenerateMoves(&game, &list);
+        int mover = game.current_player == 0 ? red_engine : 1 - red_engine;
+        if (list.count == 0) {
+            record->result = game.current_player == 0 ? RESULT_BLACK_WINS : RESULT_RED_WINS;
+            if (view != NULL) ShowGame(view, number, &game, ply, mover == 0 ? "e2 won" : "e1 won");
+            return mover == 0 ? -1 : 1;
+        }
+        if (ply >= settings.max_plies || HistoryIsDraw(history)) {
+            record->result = RESULT_DRAW;
+            if (view != NULL) ShowGame(view, number, &game, ply, "draw");
+            return 0;
+        }
+
+        MoveList legal;
+        const Move* move = EngineMove(&engines[mover], start, moves, &game, &legal);
+        if (move == NULL) {
+            record->result = game.current_player == 0 ? RESULT_BLACK_WINS : RESULT_RED_WINS;
+            *forfeit = mover;
+            if (view != NULL) ShowGame(view, number, &game, ply, mover == 0 ? "e1 forfeit" : "e2 forfeit");
+            return mover == 0 ? -1 : 1;
+        }
+
+        char text[MOVE_TEXT_SIZE];
+        FormatMove(&game, move, text);
+        RecordAddMove(record, move);
+        HistoryAddMove(history, move);
+        game = history->position;
+        if (HistoryQuietPlies(history) == 0) {
+            FormatPosition(&game, start, sizeof(start));
+            moves_length = 0;
+            moves[0] = '\0';
+        } else {
+            moves_length += sprintf(moves + moves_length, " %s", text);
+        }
+    }
+}
+
+// Elo difference for an expected score
+static double EloFromScore(double score) {
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return 400.0 * log10(score / (1.0 - score));
+}
+
+static double ScoreFromElo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+/**
+ * Log-likelihood ratio of elo1 against elo0 given the results so far
+ * (normal approximation of the trinomial win/draw/loss model)
+ * @return LLR, 0 while there is not enough data
+ */
+static double SprtLLR(const Score* total) {
+    double games = total->wins + total->draws + total->losses;
+    if (games == 0) return 0.0;
+
+    double mean = (total->wins + 0.5 * total->draws) / games;
+    double variance = (total->wins * (1 - mean) * (1 - mean) +
+                       total->draws * (0.5 - mean) * (0.5 - mean) +
+                       total->losses * mean * mean) / games;
+    if (variance <= 0) return 0.0;
+    double s0 = ScoreFromElo(settings.elo0), s1 = ScoreFromElo(settings.elo1);
+    return (s1 - s0) * (2 * mean - s0 - s1) / (2 * variance / games);
+}
+
+// Formats the score line: results, Elo estimate and (with --sprt) the LLR and its bounds
+static void FormatScore(const Score* total, char* text, size_t size) {
+    double games = total->wins + total->draws + total->losses;
+    double mean = games > 0 ? (total->wins + 0.5 * total->draws) / games : 0.5;
+    double variance = games > 0 ? (total->wins * (1 - mean) * (1 - mean) +
+                                   total->draws * (0.5 - mean) * (0.5 - mean) +
+                                   total->losses * mean * mean) / games : 0.0;
+    double margin = games > 0 ? 1.96 * sqrt(variance / games) : 0.0;
+    double elo = EloFromScore(mean);
+    double error = (EloFromScore(mean + margin) - EloFromScore(mean - margin)) / 2;
+
+    // The margin is unbounded while every game has the same result (or the interval reaches 0 or 1)
+    char error_text[32];
+    if (isfinite(error) && (games == 0 || variance > 0)) {
+        snprintf(error_text, sizeof(error_text), "%.1f", error);
+    } else {
+        snprintf(error_text, sizeof(error_text), "inf");
+    }
+    int length = snprintf(text, size, "Games %.0f: +%llu -%llu =%llu  Elo %+.1f +/- %s", games,
+                          total->wins, total->losses, total->draws, elo, error_text);
+    if (settings.sprt && length < (int)size) {
+        double lower = log(settings.beta / (1 - settings.alpha));
+        double upper = log((1 - settings.beta) / settings.alpha);
+        snprintf(text + length, size - length, "  LLR %.2f [%.2f, %.2f]", SprtLLR(total), lower, upper);
+    }
+}
+
+// Prints the running score line
+static void PrintScore(const Score* total, int final) {
+    char text[256];
+    FormatScore(total, text, sizeof(text));
+    printf(final ? "%s\n" : "\r%s   ", text);
+    fflush(stdout);
+}
+
+// Adds one finished game; returns 1 once the SPRT has reached a decision
+static int AddResult(int result, int forfeit) {
+    pthread_mutex_lock(&score_lock);
+    if (result > 0) score.wins++;
+    else if (result < 0) score.losses++;
+    else score.draws++;
+    if (forfeit >= 0) score.forfeits[forfeit]++;
+
+    int decided = 0;
+    if (settings.sprt) {
+        double llr = SprtLLR(&score);
+        decided = llr <= log(settings.beta / (1 - settings.alpha)) ||
+                  llr >= log((1 - settings.beta) / settings.alpha);
+    }
+    if (live == NULL) PrintScore(&score, 0);
+    pthread_mutex_unlock(&score_lock);
+    return decided;
+}
+
+// Worker: keeps a pair of engines and plays games until the match is over
+static void* Worker(void* arg) {
+    LiveGame* view = live != NULL ? &live[(size_t)arg] : NULL;
+    Engine engines[2];
+    memset(engines, 0, sizeof(engines));
+    GameRecord* record = malloc(sizeof(GameRecord));
+    GameHistory* history = malloc(sizeof(GameHistory));
+    if (record == NULL || history == NULL) {
+        printf("Error: Could not allocate worker state!\n");
+        exit(1);
+    }
+
+    while (!__atomic_load_n(&stop_match, __ATOMIC_RELAXED)) {
+        unsigned long long number = __atomic_fetch_add(&next_game, 1, __ATOMIC_RELAXED);
+        if (number >= settings.games) break;
+
+        // (Re)start engines that are not running, e.g. after a crash or a lost-on-time game
+        for (int i = 0; i < 2; i++) {
+            engines[i].config = &settings.engines[i];
+            if (engines[i].pid == 0 && !EngineStart(&engines[i])) {
+                printf("\nError: Could not start '%s'!\n", settings.engines[i].command);
+                exit(1);
+            }
+        }
+
+        int forfeit;
+        int result = PlayGame(number, engines, record, history, view, &forfeit);
+        if (forfeit >= 0) EngineStop(&engines[forfeit]);
+
+        if (settings.output != NULL && ArchiveAppend(&writer, record, NULL) != FILE_OK) {
+            __atomic_store_n(&write_failed, 1, __ATOMIC_RELAXED);
+        }
+        if (AddResult(result, forfeit)) __atomic_store_n(&stop_match, 1, __ATOMIC_RELAXED);
+    }
+
+    EngineStop(&engines[0]);
+    EngineStop(&engines[1]);
+    free(record);
+    free(history);
+    __atomic_fetch_add(&workers_done, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Loads the usable positions of a position file as openings
+static int LoadOpenings(const char* path) {
+    int count;
+    if (LoadPositions(path, &openings, &count) != FILE_OK) return 0;
+    for (int i = 0; i < count; i++) {
+        if (openings[i].error == NULL) openings[opening_count++] = openings[i];
+    }
+    return opening_count;
+}
+
+// Spectator footer: the score so far; the last frame is drawn once every worker has finished
+static int ScoreFooter(char* footer, size_t size, void* context) {
+    (void)context;
+    int finished = __atomic_load_n(&workers_done, __ATOMIC_RELAXED) == settings.concurrency;
+    pthread_mutex_lock(&score_lock);
+    FormatScore(&score, footer, size);
+    pthread_mutex_unlock(&score_lock);
+    return finished;
+}
+
+static void PrintUsage(const char* program) {
+    printf("Usage: %s --engine1 CMD --engine2 CMD [options]\n", program);
+    printf("  --engine1 CMD     First engine (e.g. \"./checkers --protocol\")\n");
+    printf("  --engine2 CMD     Second engine\n");
+    printf("  --set1 \"NAME V\"   Engine option for the first engine (repeatable)\n");
+    printf("  --set2 \"NAME V\"   Engine option for the second engine (repeatable)\n");
+    printf("  --games N         Most games to play (default 1000)\n");
+    printf("  --concurrency N   Games played at the same time (default: all cores)\n");
+    printf("  --time MS         Time per move (default 100)\n");
+    printf("  --depth N         Search depth per move instead of time\n");
+    printf("  --nodes N         Node budget per move instead of time\n");
+    printf("  --max-plies N     Adjudicate a draw after N plies (default %d)\n", DEFAULT_MAX_PLIES);
+    printf("  --openings FILE   Position file; each opening is played with both colours\n");
+    printf("  --output FILE     Append every game to an archive\n");
+    printf("  --sprt E0 E1      Stop once Elo E1 is accepted over E0 or rejected\n");
+    printf("  --alpha A         SPRT false positive rate (default 0.05)\n");
+    printf("  --beta B          SPRT false negative rate (default 0.05)\n");
+    printf("  --watch MS        Show the running games in a grid redrawn every MS milliseconds\n");
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+    signal(SIGPIPE, SIG_IGN);
+
+    settings.games = 1000;
+    settings.concurrency = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    settings.time_ms = 100;
+    settings.max_plies = DEFAULT_MAX_PLIES;
+    settings.alpha = 0.05;
+    settings.beta = 0.05;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strncmp(argv[i], "--engine", 8) == 0 && (argv[i][8] == '1' || argv[i][8] == '2') &&
+            argv[i][9] == '\0' && has_value) {
+            int side = argv[i][8] - '1';
+            settings.engines[side].command = argv[++i];
+        } else if (strncmp(argv[i], "--set", 5) == 0 && (argv[i][5] == '1' || argv[i][5] == '2') &&
+                   argv[i][6] == '\0' && has_value) {
+            int side = argv[i][5] - '1';
+            EngineConfig* config = &settings.engines[side];
+            if (config->option_count == MAX_OPTIONS) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            config->options[config->option_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--games") == 0 && has_value) {
+            settings.games = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--concurrency") == 0 && has_value) {
+            settings.concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time") == 0 && has_value) {
+            settings.time_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--depth") == 0 && has_value) {
+            settings.depth = atoi(argv[++i]);
+            settings.time_ms = 0;
+        } else if (strcmp(argv[i], "--nodes") == 0 && has_value) {
+            settings.nodes = strtoull(argv[++i], NULL, 10);
+            settings.time_ms = 0;
+        } else if (strcmp(argv[i], "--max-plies") == 0 && has_value) {
+            settings.max_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--openings") == 0 && has_value) {
+            settings.openings = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            settings.output = argv[++i];
+        } else if (strcmp(argv[i], "--sprt") == 0 && i + 2 < argc) {
+            settings.elo0 = atof(argv[++i]);
+            settings.elo1 = atof(argv[++i]);
+            settings.sprt = 1;
+        } else if (strcmp(argv[i], "--alpha") == 0 && has_value) {
+            settings.alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--beta") == 0 && has_value) {
+            settings.beta = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--watch") == 0 && has_value) {
+            settings.watch_ms = atoi(argv[++i]);
+            if (settings.watch_ms <= 0) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (settings.engines[0].command == NULL || settings.engines[1].command == NULL ||
+        settings.games == 0 || settings.concurrency <= 0 ||
+        (settings.time_ms <= 0 && settings.depth <= 0 && settings.nodes == 0) ||
+        settings.max_plies <= 0 || settings.max_plies >= RECORD_MAX_PLIES ||
+        (settings.sprt && settings.elo1 <= settings.elo0) ||
+        settings.alpha <= 0 || settings.alpha >= 0.5 || settings.beta <= 0 || settings.beta >= 0.5) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (settings.openings != NULL && !LoadOpenings(settings.openings)) {
+        printf("Error: Could not read openings from '%s'!\n", settings.openings);
+        return 1;
+    }
+    if (settings.output != NULL && ArchiveWriterOpen(&writer, settings.output) != FILE_OK) {
+        printf("Error: Could not open '%s' for writing!\n", settings.output);
+        return 1;
+    }
+
+    printf("Match: '%s' vs '%s', up to %llu games, %d at a time", settings.engines[0].command,
+           settings.engines[1].command, settings.games, settings.concurrency);
+    if (settings.time_ms > 0) printf(", %d ms/move", settings.time_ms);
+    else if (settings.nodes > 0) printf(", %llu nodes/move", settings.nodes);
+    else printf(", depth %d", settings.depth);
+    if (opening_count > 0) printf(", %d openings", opening_count);
+    if (settings.sprt) printf(", SPRT elo0 %.1f elo1 %.1f", settings.elo0, settings.elo1);
+    printf("\n");
+
+    pthread_t* workers = malloc(settings.concurrency * sizeof(pthread_t));
+    // The grid needs a terminal; redirected output gets the plain score lines
+    if (settings.watch_ms > 0 && !isatty(STDOUT_FILENO)) settings.watch_ms = 0;
+    if (settings.watch_ms > 0) live = LiveGamesCreate(settings.concurrency);
+    if (workers == NULL || (settings.watch_ms > 0 && live == NULL)) {
+        printf("Error: Could not allocate worker state!\n");
+        return 1;
+    }
+    start_time = Now();
+    // Workers take games from a shared counter, so fewer of them still play the match;
+    // the spectator waits for as many workers as were started
+    int started = 0;
+    while (started < settings.concurrency &&
+           pthread_create(&workers[started], NULL, Worker, (void*)(size_t)started) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        printf("Error: Could not start any worker thread!\n");
+        return 1;
+    }
+    if (started < settings.concurrency) {
+        printf("Warning: Only %d of %d worker threads could be started\n", started, settings.concurrency);
+        settings.concurrency = started;
+    }
+    if (live != NULL && !Spectate(live, settings.concurrency, settings.watch_ms, ScoreFooter, NULL)) {
+        printf("Error: Could not allocate the spectator grid!\n");
+        return 1;
+    }
+    for (int i = 0; i < settings.concurrency; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = Now() - start_time;
+
+    printf("\n\n");
+    PrintScore(&score, 1);
+    printf("Time:      %.1fs\n", elapsed);
+    printf("Forfeits:  engine1 %llu, engine2 %llu (time, illegal move or crash)\n",
+           score.forfeits[0], score.forfeits[1]);
+    if (settings.sprt) {
+        double llr = SprtLLR(&score);
+        if (llr >= log((1 - settings.beta) / settings.alpha)) {
+            printf("SPRT:      H1 accepted (engine1 is at least %.1f Elo stronger)\n", settings.elo1);
+        } else if (llr <= log(settings.beta / (1 - settings.alpha))) {
+            printf("SPRT:      H0 accepted (engine1 is not %.1f Elo stronger)\n", settings.elo1);
+        } else {
+            printf("SPRT:      no decision after %llu games\n", score.wins + score.draws + score.losses);
+        }
+    }
+
+    if (settings.output != NULL) {
+        if (ArchiveWriterClose(&writer) != FILE_OK) write_failed = 1;
+        if (write_failed) {
+            printf("Error: Writing '%s' failed!\n", settings.output);
+            return 1;
+        }
+        printf("Games appended to '%s'\n", settings.output);
+    }
+    return 0;
+}
@@ -0,0 +1,459 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitops.h"
+#include "board.h"
+#include "eval.h"
+#include "game.h"
+#include "movegen.h"
+
+// Fixed corpus: positions along seeded random games, identical on every run
+#define CORPUS_GAMES     64
+#define CORPUS_MAX_PLIES 100
+#define CORPUS_SEED      0x62656E6368ULL    // "bench"
+
+// A run repeats its benchmark until it lasts at least this long
+#define MIN_RUN_SECONDS 0.002
+
+#define DEFAULT_RUNS   21
+#define DEFAULT_WARMUP 3
+
+// One single-step move in row/column form, as MakeMove/MovePiece/CapturePiece take it
+typedef struct {
+    int position;                       // Corpus index
+    int from;
+    int to;
+    int captured;                       // Jumped square (-1 for a plain step)
+} Step;
+
+typedef struct {
+    GameState positions[CORPUS_GAMES * CORPUS_MAX_PLIES];
+    MoveList moves[CORPUS_GAMES * CORPUS_MAX_PLIES];
+    int count;
+    Step steps[CORPUS_GAMES * CORPUS_MAX_PLIES * 4];
+    int step_count;
+    Step jumps[CORPUS_GAMES * CORPUS_MAX_PLIES * 4];
+    int jump_count;
+    PositionBlock block;
+} Corpus;
+
+// Runs one pass over the corpus; returns a checksum and sets the number of operations timed
+typedef unsigned long long (*BenchFunction)(Corpus* corpus, unsigned long long* ops);
+
+typedef struct {
+    const char* name;
+    BenchFunction run;
+} Benchmark;
+
+// Timing summary of one benchmark, in nanoseconds per operation
+typedef struct {
+    unsigned long long ops_per_run;
+    double min, p10, median, p90, max, mean;
+} BenchStats;
+
+// Keeps the compiler from discarding benchmark results
+static volatile unsigned long long sink;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long long NextRandom(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// First jump of a capture sequence: a captured neighbour with an empty square behind it
+static int FirstJump(const GameState* game, const Move* move, Step* step) {
+    unsigned long long occupied = game->red_pieces | game->red_kings | game->black_pieces | game->black_kings;
+    int row = move->from / 8, col = move->from % 8;
+    for (int dr = -1; dr <= 1; dr += 2) {
+        for (int dc = -1; dc <= 1; dc += 2) {
+            if (!IsValidPosition(row + 2 * dr, col + 2 * dc)) continue;
+            int victim = GetPosition(row + dr, col + dc);
+            int landing = GetPosition(row + 2 * dr, col + 2 * dc);
+            if (GetBit(move->captured, victim) && !GetBit(occupied, landing)) {
+                step->from = move->from;
+                step->to = landing;
+                step->captured = victim;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Plays seeded random games and keeps every position with its moves
+// Returns 0 if the position block could not be allocated
+static int BuildCorpus(Corpus* corpus) {
+    unsigned long long seed = CORPUS_SEED;
+    corpus->count = 0;
+    corpus->step_count = 0;
+    corpus->jump_count = 0;
+    if (!PositionBlockInit(&corpus->block, CORPUS_GAMES * CORPUS_MAX_PLIES)) return 0;
+
+    for (int g = 0; g < CORPUS_GAMES; g++) {
+        GameState game;
+        InitializeGame(&game);
+        for (int ply = 0; ply < CORPUS_MAX_PLIES; ply++) {
+            MoveList* list = &corpus->moves[corpus->count];
+            if (GenerateMoves(&game, list) == 0) break;
+
+            int index = corpus->count++;
+            corpus->positions[index] = game;
+            PositionBlockAdd(&corpus->block, &game);
+            for (int i = 0; i < list->count; i++) {
+                const Move* move = &list->moves[i];
+                if (move->captured == 0ULL) {
+                    Step* step = &corpus->steps[corpus->step_count++];
+                    step->position = index;
+                    step->from = move->from;
+                    step->to = move->to;
+                    step->captured = -1;
+                } else if (FirstJump(&game, move, &corpus->jumps[corpus->jump_count])) {
+                    corpus->jumps[corpus->jump_count++].position = index;
+                }
+            }
+            DoMove(&game, &list->moves[NextRandom(&seed) % list->count]);
+        }
+    }
+    return 1;
+}
+
+static unsigned long long BenchCountBits(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        const GameState* game = &corpus->positions[i];
+        sum += CountBits(game->red_pieces) + CountBits(game->red_kings) +
+               CountBits(game->black_pieces) + CountBits(game->black_kings);
+    }
+    *ops = 4ULL * corpus->count;
+    return sum;
+}
+
+static unsigned long long BenchSingleBits(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        unsigned long long board = corpus->positions[i].red_pieces;
+        for (int pos = 0; pos < 64; pos++) {
+            board = SetBit(board, pos);
+            board = ClearBit(board, (pos * 7 + i) & 63);
+            sum += GetBit(board, (pos * 5 + i) & 63);
+        }
+    }
+    *ops = 3ULL * 64 * corpus->count;
+    return sum;
+}
+
+static unsigned long long BenchSquareQueries(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        GameState* game = &corpus->positions[i];
+        for (int pos = 1; pos < 64; pos += 2) {
+            sum += IsOwnPiece(game, pos) + 2 * IsEmpty(game, pos);
+        }
+    }
+    *ops = 2ULL * 32 * corpus->count;
+    return sum;
+}
+
+static unsigned long long BenchMakeMove(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->step_count; i++) {
+        const Step* step = &corpus->steps[i];
+        GameState game = corpus->positions[step->position];
+        sum += MakeMove(&game, step->from / 8, step->from % 8, step->to / 8, step->to % 8, NULL) + game.hash;
+    }
+    *ops = corpus->step_count;
+    return sum;
+}
+
+static unsigned long long BenchMovePiece(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->step_count; i++) {
+        const Step* step = &corpus->steps[i];
+        GameState game = corpus->positions[step->position];
+        sum += MovePiece(&game, step->from, step->to) + game.hash;
+    }
+    *ops = corpus->step_count;
+    return sum;
+}
+
+static unsigned long long BenchCapturePiece(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->jump_count; i++) {
+        const Step* jump = &corpus->jumps[i];
+        GameState game = corpus->positions[jump->position];
+        sum += CapturePiece(&game, jump->from, jump->to, jump->captured) + game.hash;
+    }
+    *ops = corpus->jump_count;
+    return sum;
+}
+
+static unsigned long long BenchExecuteMove(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0, count = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        const MoveList* list = &corpus->moves[i];
+        for (int j = 0; j < list->count; j++) {
+            GameState game = corpus->positions[i];
+            sum += ExecuteMove(&game, &list->moves[j]) + game.hash;
+        }
+        count += list->count;
+    }
+    *ops = count;
+    return sum;
+}
+
+static unsigned long long BenchGenerateMoves(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    MoveList list;
+    for (int i = 0; i < corpus->count; i++) {
+        sum += GenerateMoves(&corpus->positions[i], &list);
+    }
+    *ops = corpus->count;
+    return sum;
+}
+
+static unsigned long long BenchDoUndoMove(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0, count = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        GameState* game = &corpus->positions[i];
+        const MoveList* list = &corpus->moves[i];
+        for (int j = 0; j < list->count; j++) {
+            DoMove(game, &list->moves[j]);
+            sum += game->hash;
+            UndoMove(game, &list->moves[j]);
+        }
+        count += list->count;
+    }
+    *ops = count;
+    return sum;
+}
+
+static unsigned long long BenchEvaluate(Corpus* corpus, unsigned long long* ops) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < corpus->count; i++) {
+        sum += Evaluate(&corpus->positions[i]);
+    }
+    *ops = corpus->count;
+    return sum;
+}
+
+static unsigned long long BenchEvaluateBatch(Corpus* corpus, unsigned long long* ops) {
+    static int scores[CORPUS_GAMES * CORPUS_MAX_PLIES];
+    unsigned long long sum = 0;
+    EvaluateBatch(&corpus->block, scores);
+    for (int i = 0; i < corpus->count; i += 64) sum += scores[i];
+    *ops = corpus->count;
+    return sum;
+}
+
+static const Benchmark BENCHMARKS[] = {
+    { "count_bits",            BenchCountBits },
+    { "set_clear_get_bit",     BenchSingleBits },
+    { "is_own_piece_is_empty", BenchSquareQueries },
+    { "make_move",             BenchMakeMove },
+    { "move_piece",            BenchMovePiece },
+    { "capture_piece",         BenchCapturePiece },
+    { "execute_move",          BenchExecuteMove },
+    { "generate_moves",        BenchGenerateMoves },
+    { "do_undo_move",          BenchDoUndoMove },
+    { "evaluate",              BenchEvaluate },
+    { "evaluate_batch",        BenchEvaluateBatch },
+};
+#define BENCHMARK_COUNT ((int)(sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0])))
+
+static int CompareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double Percentile(const double* sorted, int count, int percent) {
+    int rank = (percent * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * Times one benchmark
+ * The repeat count is doubled until a run lasts MIN_RUN_SECONDS (this also
+ * warms caches and branch predictors), then warmup runs are discarded and
+ * each timed run yields one nanoseconds-per-operation sample.
+ */
+static void RunBenchmark(const Benchmark* bench, Corpus* corpus, int runs, int warmup, BenchStats* stats) {
+    unsigned long long ops = 0;
+    int repeats = 1;
+    for (;;) {
+        double start = Now();
+        for (int r = 0; r < repeats; r++) sink += bench->run(corpus, &ops);
+        if (Now() - start >= MIN_RUN_SECONDS || repeats >= (1 << 20)) break;
+        repeats *= 2;
+    }
+
+    double* samples = malloc(runs * sizeof(double));
+    for (int run = -warmup; run < runs; run++) {
+        double start = Now();
+        for (int r = 0; r < repeats; r++) sink += bench->run(corpus, &ops);
+        double elapsed = Now() - start;
+        if (run >= 0) samples[run] = ops > 0 ? elapsed * 1e9 / ((double)ops * repeats) : 0;
+    }
+    qsort(samples, runs, sizeof(double), CompareDoubles);
+
+    stats->ops_per_run = ops * repeats;
+    stats->min = samples[0];
+    stats->p10 = Percentile(samples, runs, 10);
+    stats->median = Percentile(samples, runs, 50);
+    stats->p90 = Percentile(samples, runs, 90);
+    stats->max = samples[runs - 1];
+    stats->mean = 0;
+    for (int i = 0; i < runs; i++) stats->mean += samples[i] / runs;
+    free(samples);
+}
+
+// Reads the medians of an earlier JSON report; returns 1 if one was found for name
+static int BaselineMedian(const char* path, const char* name, double* median) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return 0;
+
+    char line[512];
+    char found[64];
+    int ok = 0;
+    while (!ok && fgets(line, sizeof(line), file)) {
+        const char* entry = strstr(line, "{\"name\": \"");
+        const char* value = strstr(line, "\"median_ns\": ");
+        if (entry == NULL || value == NULL) continue;
+        if (sscanf(entry, "{\"name\": \"%63[^\"]\"", found) == 1 && strcmp(found, name) == 0) {
+            ok = sscanf(value, "\"median_ns\": %lf", median) == 1;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+// Writes text as a JSON string literal (quotes, backslashes and control characters escaped)
+static void WriteJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const unsigned char* c = (const unsigned char*)text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(file, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Writes every result on its own line so reports diff cleanly between commits
+static int WriteJson(const char* path, const char* label, const Corpus* corpus, int runs, int warmup,
+                     const Benchmark* benches[], const BenchStats* stats, int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return 0;
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"label\": ");
+    WriteJsonString(file, label);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"evaluate_batch_backend\": \"%s\",\n", EvaluateBatchBackend());
+    fprintf(file, "  \"corpus_positions\": %d,\n", corpus->count);
+    fprintf(file, "  \"runs\": %d,\n", runs);
+    fprintf(file, "  \"warmup\": %d,\n", warmup);
+    fprintf(file, "  \"unit\": \"ns/op\",\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchStats* s = &stats[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ops_per_run\": %llu, \"min_ns\": %.3f, \"p10_ns\": %.3f, "
+                "\"median_ns\": %.3f, \"p90_ns\": %.3f, \"max_ns\": %.3f, \"mean_ns\": %.3f}%s\n",
+                benches[i]->name, s->ops_per_run, s->min, s->p10, s->median, s->p90, s->max, s->mean,
+                i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    int runs = DEFAULT_RUNS;
+    int warmup = DEFAULT_WARMUP;
+    const char* json = NULL;
+    const char* baseline = NULL;
+    const char* filter = NULL;
+    const char* label = "";
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--runs") == 0 && has_value) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && has_value) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && has_value) {
+            json = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && has_value) {
+            baseline = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && has_value) {
+            label = argv[++i];
+        } else {
+            runs = 0;
+            break;
+        }
+    }
+
+    if (runs <= 0 || warmup < 0) {
+        printf("Usage: %s [--runs N] [--warmup N] [--json FILE] [--baseline FILE] [--filter TEXT] [--label TEXT]\n",
+               argv[0]);
+        printf("Times the core primitives on a fixed corpus (ns per operation, %d runs by default).\n",
+               DEFAULT_RUNS);
+        printf("--json writes the results; --baseline compares medians with an earlier JSON file.\n");
+        return 1;
+    }
+
+    Corpus* corpus = malloc(sizeof(Corpus));
+    if (corpus == NULL || !BuildCorpus(corpus)) {
+        printf("Error: Could not allocate the benchmark corpus!\n");
+        return 1;
+    }
+    printf("Corpus: %d positions, %d steps, %d jumps; %d runs after %d warmup\n\n",
+           corpus->count, corpus->step_count, corpus->jump_count, runs, warmup);
+    printf("%-22s %10s %10s %10s %10s", "Benchmark", "min", "p10", "median", "p90");
+    printf(baseline != NULL ? " %10s %8s\n" : "\n", "baseline", "change");
+
+    const Benchmark* selected[BENCHMARK_COUNT];
+    BenchStats stats[BENCHMARK_COUNT];
+    int count = 0;
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        if (filter != NULL && strstr(BENCHMARKS[i].name, filter) == NULL) continue;
+        selected[count] = &BENCHMARKS[i];
+        BenchStats* s = &stats[count++];
+        RunBenchmark(&BENCHMARKS[i], corpus, runs, warmup, s);
+
+        printf("%-22s %10.2f %10.2f %10.2f %10.2f", BENCHMARKS[i].name, s->min, s->p10, s->median, s->p90);
+        double old;
+        if (baseline != NULL && BaselineMedian(baseline, BENCHMARKS[i].name, &old) && old > 0) {
+            printf(" %10.2f %+7.1f%%", old, 100.0 * (s->median - old) / old);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    printf("\nTimes are nanoseconds per operation.\n");
+
+    if (json != NULL) {
+        if (!WriteJson(json, label, corpus, runs, warmup, selected, stats, count)) {
+            printf("Error: Could not write '%s'!\n", json);
+            return 1;
+        }
+        printf("Results written to '%s'\n", json);
+    }
+
+    PositionBlockFree(&corpus->block);
+    free(corpus);
+    return 0;
+}
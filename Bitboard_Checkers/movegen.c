@@ -0,0 +1,330 @@
+#include <stddef.h>
+#include "movegen.h"
+#include "board.h"
+#include "bitops.h"
+#include "stats.h"
+#include "zobrist.h"
+
+// Everything a capture sequence needs to know about the position it started in
+typedef struct {
+    unsigned long long opponents;       // Opponent pieces (captured ones stay on the board)
+    unsigned long long opponent_kings;  // Opponent kings
+    unsigned long long empty;           // Empty squares, with the origin vacated
+    unsigned long long king_row;        // Promotion row for the side to move
+    int directions[4];                  // Allowed jump directions
+    int direction_count;                // 2 for men, 4 for kings
+    int from;                           // Origin of the sequence
+    unsigned char flags;                // MOVE_KING if the jumper is a king
+} JumpContext;
+
+// Shifts a bitboard one diagonal step (positive = up, negative = down)
+static unsigned long long ShiftDiagonal(unsigned long long bb, int dir) {
+    return dir > 0 ? bb << dir : bb >> -dir;
+}
+
+// Appends one move per set bit of targets, each reached by a single step in dir
+static void AddQuietMoves(MoveList* list, unsigned long long targets, int dir,
+                          unsigned char flags, unsigned long long king_row) {
+    int to;
+    FOR_EACH_BIT(to, targets) {
+        Move* move = &list->moves[list->count++];
+        move->from = (unsigned char)(to - dir);
+        move->to = (unsigned char)to;
+        move->captured = 0ULL;
+        move->captured_kings = 0ULL;
+        move->flags = flags;
+        if (!(flags & MOVE_KING) && ((1ULL << to) & king_row)) {
+            move->flags |= MOVE_PROMOTION;
+        }
+    }
+}
+
+// Appends a finished capture sequence unless an identical one is already listed
+static void AddJump(MoveList* list, const JumpContext* ctx, int to,
+                    unsigned long long captured) {
+    for (int i = 0; i < list->count; i++) {
+        const Move* other = &list->moves[i];
+        if (other->from == ctx->from && other->to == to && other->captured == captured) {
+            return;
+        }
+    }
+    if (list->count >= MAX_MOVES) return;
+
+    Move* move = &list->moves[list->count++];
+    move->from = (unsigned char)ctx->from;
+    move->to = (unsigned char)to;
+    move->captured = captured;
+    move->captured_kings = captured & ctx->opponent_kings;
+    move->flags = ctx->flags;
+    if (!(ctx->flags & MOVE_KING) && ((1ULL << to) & ctx->king_row)) {
+        move->flags |= MOVE_PROMOTION;
+    }
+}
+
+// Follows every continuation of a capture sequence currently standing on square
+static void ExtendJump(MoveList* list, const JumpContext* ctx, int square,
+                       unsigned long long captured) {
+    unsigned long long here = 1ULL << square;
+
+    // A man that reaches the king row is crowned and the move ends
+    if (!(ctx->flags & MOVE_KING) && (here & ctx->king_row) && captured) {
+        AddJump(list, ctx, square, captured);
+        return;
+    }
+
+    int extended = 0;
+    for (int i = 0; i < ctx->direction_count; i++) {
+        int dir = ctx->directions[i];
+        unsigned long long victim = ShiftDiagonal(here, dir) & ctx->opponents & ~captured;
+        unsigned long long landing = ShiftDiagonal(victim, dir) & ctx->empty;
+        if (landing) {
+            extended = 1;
+            ExtendJump(list, ctx, LowestBit(landing), captured | victim);
+        }
+    }
+
+    if (!extended && captured) {
+        AddJump(list, ctx, square, captured);
+    }
+}
+
+// Expands every jumper in jumpers into its complete capture sequences
+static void AddCaptureSequences(MoveList* list, JumpContext* ctx, unsigned long long jumpers,
+                                unsigned long long empty) {
+    int from;
+    FOR_EACH_BIT(from, jumpers) {
+        ctx->from = from;
+        ctx->empty = empty | (1ULL << from);
+        ExtendJump(list, ctx, from, 0ULL);
+    }
+}
+
+// Returns the pieces of movers that can capture in direction dir
+static unsigned long long JumpersInDirection(unsigned long long movers, unsigned long long opponents,
+                                             unsigned long long empty, int dir) {
+    unsigned long long landings = ShiftDiagonal(ShiftDiagonal(movers, dir) & opponents, dir) & empty;
+    return ShiftDiagonal(landings, -2 * dir);
+}
+
+/**
+ * Generates every legal move for the side to move
+ * Works on whole bitboards: finding quiet moves and the pieces able to jump
+ * costs a couple of shifts and masks per direction. Stepping off a board
+ * edge always lands on a light square, so masking with PLAYABLE_SQUARES is
+ * enough to discard wrapped bits. Captures are mandatory: when any jump
+ * exists only complete capture sequences are returned, each one followed to
+ * its end (a man reaching the king row is crowned and stops).
+ * @param game Pointer to game state
+ * @param list Move list to fill (previous contents are discarded)
+ * @return Number of moves generated
+ */
+int GenerateMoves(const GameState* game, MoveList* list) {
+    STATS_TIMER_START(generate);
+    STATS_INC(STAT_GENERATE_CALLS);
+    unsigned long long own_men, own_kings, opponents, opponent_kings, king_row;
+    int forward_left, forward_right, back_left, back_right;
+
+    if (game->current_player == 0) {  // Red moves up
+        own_men = game->red_pieces;
+        own_kings = game->red_kings;
+        opponents = game->black_pieces | game->black_kings;
+        opponent_kings = game->black_kings;
+        king_row = RED_KING_ROW;
+        forward_left = UP_LEFT;
+        forward_right = UP_RIGHT;
+        back_left = DOWN_LEFT;
+        back_right = DOWN_RIGHT;
+    } else {  // Black moves down
+        own_men = game->black_pieces;
+        own_kings = game->black_kings;
+        opponents = game->red_pieces | game->red_kings;
+        opponent_kings = game->red_kings;
+        king_row = BLACK_KING_ROW;
+        forward_left = DOWN_LEFT;
+        forward_right = DOWN_RIGHT;
+        back_left = UP_LEFT;
+        back_right = UP_RIGHT;
+    }
+
+    unsigned long long movers = own_men | own_kings;
+    unsigned long long empty = PLAYABLE_SQUARES & ~(movers | opponents);
+
+    list->count = 0;
+
+    // Pieces able to start a capture: step onto an opponent, then onto an empty square
+    unsigned long long men_jumpers =
+        JumpersInDirection(own_men, opponents, empty, forward_left) |
+        JumpersInDirection(own_men, opponents, empty, forward_right);
+    unsigned long long king_jumpers =
+        JumpersInDirection(own_kings, opponents, empty, forward_left) |
+        JumpersInDirection(own_kings, opponents, empty, forward_right) |
+        JumpersInDirection(own_kings, opponents, empty, back_left) |
+        JumpersInDirection(own_kings, opponents, empty, back_right);
+
+    if (men_jumpers | king_jumpers) {
+        JumpContext ctx;
+        ctx.opponents = opponents;
+        ctx.opponent_kings = opponent_kings;
+        ctx.king_row = king_row;
+        ctx.directions[0] = forward_left;
+        ctx.directions[1] = forward_right;
+        ctx.directions[2] = back_left;
+        ctx.directions[3] = back_right;
+
+        ctx.direction_count = 2;
+        ctx.flags = 0;
+        AddCaptureSequences(list, &ctx, men_jumpers, empty);
+
+        ctx.direction_count = 4;
+        ctx.flags = MOVE_KING;
+        AddCaptureSequences(list, &ctx, king_jumpers, empty);
+        STATS_ADD(STAT_MOVES_GENERATED, list->count);
+        STATS_ADD(STAT_CAPTURES_GENERATED, list->count);
+        STATS_TIMER_STOP(generate, STAT_CYCLES_GENERATE);
+        return list->count;
+    }
+
+    // Quiet moves: a single step onto an empty square
+    AddQuietMoves(list, ShiftDiagonal(own_men, forward_left) & empty, forward_left, 0, king_row);
+    AddQuietMoves(list, ShiftDiagonal(own_men, forward_right) & empty, forward_right, 0, king_row);
+    AddQuietMoves(list, ShiftDiagonal(own_kings, forward_left) & empty, forward_left, MOVE_KING, king_row);
+    AddQuietMoves(list, ShiftDiagonal(own_kings, forward_right) & empty, forward_right, MOVE_KING, king_row);
+    AddQuietMoves(list, ShiftDiagonal(own_kings, back_left) & empty, back_left, MOVE_KING, king_row);
+    AddQuietMoves(list, ShiftDiagonal(own_kings, back_right) & empty, back_right, MOVE_KING, king_row);
+
+    STATS_ADD(STAT_MOVES_GENERATED, list->count);
+    STATS_TIMER_STOP(generate, STAT_CYCLES_GENERATE);
+    return list->count;
+}
+
+/**
+ * Looks up a generated move by its origin and final destination
+ * A king's capture sequences can share both squares and differ only in the
+ * pieces taken; then there is no single answer and NULL is returned, with
+ * matches telling the caller why. FindCapture picks one of them exactly.
+ * @param list Generated moves
+ * @param from_pos Origin bit position
+ * @param to_pos Destination bit position
+ * @param matches Output (may be NULL): number of moves between the two squares
+ * @return The matching move, or NULL if the list has none or several
+ */
+const Move* FindMove(const MoveList* list, int from_pos, int to_pos, int* matches) {
+    const Move* found = NULL;
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->moves[i].from == from_pos && list->moves[i].to == to_pos) {
+            found = &list->moves[i];
+            count++;
+        }
+    }
+    if (matches != NULL) *matches = count;
+    return count == 1 ? found : NULL;
+}
+
+// Looks up a generated move by its end squares and the pieces it captures (NULL if none)
+const Move* FindCapture(const MoveList* list, int from_pos, int to_pos, unsigned long long captured) {
+    for (int i = 0; i < list->count; i++) {
+        const Move* move = &list->moves[i];
+        if (move->from == from_pos && move->to == to_pos && move->captured == captured) {
+            return move;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Packs a move into 16 bits
+ * The captured-set tag tells apart capture sequences that share both end
+ * squares; decoding therefore needs the position's generated move list.
+ * @param move Generated move
+ * @return Move code (never NO_MOVE)
+ */
+unsigned short EncodeMove(const Move* move) {
+    unsigned int tag = (unsigned int)((move->captured * 0x9E3779B97F4A7C15ULL) >> 58);
+    return (unsigned short)((move->from >> 1) | ((move->to >> 1) << 5) | (tag << 10));
+}
+
+/**
+ * Looks up a generated move by its 16-bit code
+ * @param list Moves generated for the position the code was made in
+ * Two capture sequences with the same end squares can share a code (their
+ * 6-bit tags collide); the code then names neither, rather than the first.
+ * @param code Code from EncodeMove
+ * @return Matching move, or NULL if none or several match (stale code or NO_MOVE)
+ */
+const Move* FindEncodedMove(const MoveList* list, unsigned short code) {
+    if (code == NO_MOVE) return NULL;
+    const Move* found = NULL;
+    for (int i = 0; i < list->count; i++) {
+        if (EncodeMove(&list->moves[i]) != code) continue;
+        if (found != NULL) return NULL;
+        found = &list->moves[i];
+    }
+    return found;
+}
+
+// XORs a move's delta into the bitboards of the side that owns it
+static void ApplyMoveDelta(GameState* game, const Move* move) {
+    unsigned long long *men, *kings, *opponent_men, *opponent_kings;
+    const unsigned long long *man_keys, *king_keys, *opponent_man_keys, *opponent_king_keys;
+
+    if (game->current_player == 0) {
+        men = &game->red_pieces;
+        kings = &game->red_kings;
+        opponent_men = &game->black_pieces;
+        opponent_kings = &game->black_kings;
+        man_keys = ZOBRIST_KEYS[ZOBRIST_RED_MAN];
+        king_keys = ZOBRIST_KEYS[ZOBRIST_RED_KING];
+        opponent_man_keys = ZOBRIST_KEYS[ZOBRIST_BLACK_MAN];
+        opponent_king_keys = ZOBRIST_KEYS[ZOBRIST_BLACK_KING];
+    } else {
+        men = &game->black_pieces;
+        kings = &game->black_kings;
+        opponent_men = &game->red_pieces;
+        opponent_kings = &game->red_kings;
+        man_keys = ZOBRIST_KEYS[ZOBRIST_BLACK_MAN];
+        king_keys = ZOBRIST_KEYS[ZOBRIST_BLACK_KING];
+        opponent_man_keys = ZOBRIST_KEYS[ZOBRIST_RED_MAN];
+        opponent_king_keys = ZOBRIST_KEYS[ZOBRIST_RED_KING];
+    }
+
+    unsigned long long from_bit = 1ULL << move->from;
+    unsigned long long to_bit = 1ULL << move->to;
+
+    // XOR rather than OR: a king circling back to its origin has from == to
+    if (move->flags & MOVE_KING) {
+        *kings ^= from_bit ^ to_bit;
+        game->hash ^= king_keys[move->from] ^ king_keys[move->to];
+    } else if (move->flags & MOVE_PROMOTION) {
+        *men ^= from_bit;
+        *kings ^= to_bit;
+        game->hash ^= man_keys[move->from] ^ king_keys[move->to];
+    } else {
+        *men ^= from_bit ^ to_bit;
+        game->hash ^= man_keys[move->from] ^ man_keys[move->to];
+    }
+
+    *opponent_men ^= move->captured ^ move->captured_kings;
+    *opponent_kings ^= move->captured_kings;
+    int pos;
+    FOR_EACH_BIT(pos, move->captured) {
+        game->hash ^= ((1ULL << pos) & move->captured_kings) ? opponent_king_keys[pos] : opponent_man_keys[pos];
+    }
+}
+
+// Plays a generated move and passes the turn
+void DoMove(GameState* game, const Move* move) {
+    STATS_INC(STAT_MOVES_MADE);
+    STATS_ADD(STAT_PIECES_CAPTURED, CountBits(move->captured));
+    STATS_ADD(STAT_PROMOTIONS, (move->flags & MOVE_PROMOTION) != 0);
+    ApplyMoveDelta(game, move);
+    game->current_player ^= 1;
+    game->hash ^= ZOBRIST_BLACK_TO_MOVE;
+}
+
+// Takes back a move played with DoMove (the delta is its own inverse)
+void UndoMove(GameState* game, const Move* move) {
+    game->current_player ^= 1;
+    game->hash ^= ZOBRIST_BLACK_TO_MOVE;
+    ApplyMoveDelta(game, move);
+}
@@ -0,0 +1,57 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <stddef.h>
+#include "board.h"
+
+// Upper bound on the number of legal moves in any position
+#define MAX_MOVES 128
+
+// Diagonal step offsets on the 8x8 bit layout (bit = row * 8 + col)
+#define UP_LEFT     7
+#define UP_RIGHT    9
+#define DOWN_LEFT  -9
+#define DOWN_RIGHT -7
+
+// Promotion rows
+#define RED_KING_ROW   0xFF00000000000000ULL
+#define BLACK_KING_ROW 0x00000000000000FFULL
+
+// Move flags
+#define MOVE_KING      0x01    // Moving piece is a king
+#define MOVE_PROMOTION 0x02    // Moving man is crowned on arrival
+
+// A complete move for the side to move, including whole capture sequences
+typedef struct {
+    unsigned long long captured;        // Bits of every jumped opponent piece (0 for quiet moves)
+    unsigned long long captured_kings;  // Subset of captured that were kings
+    unsigned char from;                 // Origin bit position
+    unsigned char to;                   // Final destination bit position
+    unsigned char flags;                // MOVE_KING / MOVE_PROMOTION
+} Move;
+
+// Fixed-capacity list of generated moves. count comes first so a list can be
+// stored in just MOVE_LIST_BYTES(count) (the search keeps them that way).
+typedef struct {
+    int count;
+    Move moves[MAX_MOVES];
+} MoveList;
+
+#define MOVE_LIST_BYTES(count) (offsetof(MoveList, moves) + (size_t)(count) * sizeof(Move))
+
+// Move generation
+int GenerateMoves(const GameState* game, MoveList* list);
+const Move* FindMove(const MoveList* list, int from_pos, int to_pos, int* matches);
+const Move* FindCapture(const MoveList* list, int from_pos, int to_pos, unsigned long long captured);
+
+// 16-bit move codes: from square (5 bits) | to square (5 bits) | captured-set tag (6 bits)
+// Squares are numbered 0-31 over the dark squares; 0 never encodes a legal move
+#define NO_MOVE 0
+unsigned short EncodeMove(const Move* move);
+const Move* FindEncodedMove(const MoveList* list, unsigned short code);
+
+// Make/unmake for search (no I/O, no promotion messages)
+void DoMove(GameState* game, const Move* move);
+void UndoMove(GameState* game, const Move* move);
+
+#endif // MOVEGEN_H
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+#include "bitops.h"
+#include "board32.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+// Weights file: header, then the NNUENetwork fields in declaration order
+#define NNUE_MAGIC   0x4E4E4B43U    // "CKNN"
+#define NNUE_VERSION 1
+
+// Network scores stay well inside the range of real evaluations
+#define NNUE_MAX_SCORE 10000
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int features;
+    unsigned int hidden;
+} NNUEFileHeader;
+
+// Network used by the search (NULL = hand-written evaluation)
+static NNUENetwork* network = NULL;
+
+// Most features one move changes per perspective: the mover twice, then every captured piece
+#define MAX_CHANGES (2 + 12)
+
+/**
+ * Maps a piece to its input feature for one perspective
+ * Black's perspective is rotated 180 degrees, so both sides see their
+ * own pieces advancing the same way.
+ * @param perspective 0 = Red, 1 = Black
+ * @param is_own 1 if the piece belongs to the perspective's side
+ * @param is_king 1 for kings
+ * @param square32 Square in the compact layout
+ * @return Feature index in [0, NNUE_FEATURES)
+ */
+int NNUEFeature(int perspective, int is_own, int is_king, int square32) {
+    int square = perspective == 0 ? square32 : 31 - square32;
+    int kind = (is_own ? 0 : 2) + (is_king ? 1 : 0);
+    return kind * 32 + square;
+}
+
+// Loads a network file; the previous network stays in use on failure
+FileStatus NNUELoad(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return FILE_ERROR_OPEN;
+    }
+
+    NNUENetwork* loaded = aligned_alloc(64, sizeof(NNUENetwork));
+    NNUEFileHeader header;
+    int ok = loaded != NULL &&
+             fread(&header, sizeof(header), 1, file) == 1 &&
+             header.magic == NNUE_MAGIC && header.version == NNUE_VERSION &&
+             header.features == NNUE_FEATURES && header.hidden == NNUE_HIDDEN &&
+             fread(loaded->feature_weights, sizeof(loaded->feature_weights), 1, file) == 1 &&
+             fread(loaded->feature_biases, sizeof(loaded->feature_biases), 1, file) == 1 &&
+             fread(loaded->output_weights, sizeof(loaded->output_weights), 1, file) == 1 &&
+             fread(&loaded->output_bias, sizeof(loaded->output_bias), 1, file) == 1 &&
+             fread(&loaded->output_scale, sizeof(loaded->output_scale), 1, file) == 1;
+    fclose(file);
+    if (!ok) {
+        free(loaded);
+        return FILE_ERROR_FORMAT;
+    }
+
+    free(network);
+    network = loaded;
+    return FILE_OK;
+}
+
+// Writes a network in the format NNUELoad reads
+FileStatus NNUESave(const NNUENetwork* net, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return FILE_ERROR_OPEN;
+    }
+
+    NNUEFileHeader header = { NNUE_MAGIC, NNUE_VERSION, NNUE_FEATURES, NNUE_HIDDEN };
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(net->feature_weights, sizeof(net->feature_weights), 1, file) == 1 &&
+             fwrite(net->feature_biases, sizeof(net->feature_biases), 1, file) == 1 &&
+             fwrite(net->output_weights, sizeof(net->output_weights), 1, file) == 1 &&
+             fwrite(&net->output_bias, sizeof(net->output_bias), 1, file) == 1 &&
+             fwrite(&net->output_scale, sizeof(net->output_scale), 1, file) == 1;
+    if (fclose(file) != 0) ok = 0;
+    return ok ? FILE_OK : FILE_ERROR_WRITE;
+}
+
+// Goes back to the hand-written evaluation (no search may be running)
+void NNUEUnload(void) {
+    free(network);
+    network = NULL;
+}
+
+// Returns 1 if a network is loaded
+int NNUEEnabled(void) {
+    return network != NULL;
+}
+
+// child = parent + added feature columns - removed feature columns
+static void ApplyChangesScalar(const short* parent, short* child, const int* added, int added_count,
+                               const int* removed, int removed_count) {
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        int value = parent[j];
+        for (int i = 0; i < added_count; i++) value += network->feature_weights[added[i]][j];
+        for (int i = 0; i < removed_count; i++) value -= network->feature_weights[removed[i]][j];
+        child[j] = (short)value;
+    }
+}
+
+// Inner layer: clipped ReLU of both halves dotted with the int8 output weights
+static int OutputDotScalar(const short* us, const short* them) {
+    int sum = 0;
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        int a = us[j] < 0 ? 0 : (us[j] > NNUE_QA ? NNUE_QA : us[j]);
+        int b = them[j] < 0 ? 0 : (them[j] > NNUE_QA ? NNUE_QA : them[j]);
+        sum += a * network->output_weights[j] + b * network->output_weights[NNUE_HIDDEN + j];
+    }
+    return sum;
+}
+
+#ifdef HAVE_X86_SIMD
+
+// ApplyChangesScalar, sixteen accumulator units per register
+__attribute__((target("avx2")))
+static void ApplyChangesAVX2(const short* parent, short* child, const int* added, int added_count,
+                             const int* removed, int removed_count) {
+    for (int j = 0; j < NNUE_HIDDEN; j += 16) {
+        __m256i value = _mm256_load_si256((const __m256i*)(parent + j));
+        for (int i = 0; i < added_count; i++) {
+            value = _mm256_add_epi16(value, _mm256_load_si256((const __m256i*)(network->feature_weights[added[i]] + j)));
+        }
+        for (int i = 0; i < removed_count; i++) {
+            value = _mm256_sub_epi16(value, _mm256_load_si256((const __m256i*)(network->feature_weights[removed[i]] + j)));
+        }
+        _mm256_store_si256((__m256i*)(child + j), value);
+    }
+}
+
+// Clips 32 accumulator units to [0, NNUE_QA] and packs them to bytes in order
+__attribute__((target("avx2")))
+static inline __m256i ClipPack(const short* values) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i limit = _mm256_set1_epi16(NNUE_QA);
+    __m256i low = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)values), zero), limit);
+    __m256i high = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(values + 16)), zero), limit);
+    // packus interleaves 128-bit lanes; restore the order of the units
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+}
+
+// OutputDotScalar with unsigned x signed byte multiply-adds (pairs never exceed int16)
+__attribute__((target("avx2")))
+static int OutputDotAVX2(const short* us, const short* them) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int half = 0; half < 2; half++) {
+        const short* values = half == 0 ? us : them;
+        const signed char* weights = network->output_weights + half * NNUE_HIDDEN;
+        for (int j = 0; j < NNUE_HIDDEN; j += 32) {
+            __m256i inputs = ClipPack(values + j);
+            __m256i products = _mm256_maddubs_epi16(inputs, _mm256_load_si256((const __m256i*)(weights + j)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+        }
+    }
+    __m128i lanes = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0x4E));
+    lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0xB1));
+    return _mm_cvtsi128_si32(lanes);
+}
+
+#endif // HAVE_X86_SIMD
+
+// Dispatches an accumulator update to the widest available code path
+static void ApplyChanges(const short* parent, short* child, const int* added, int added_count,
+                         const int* removed, int removed_count) {
+#ifdef HAVE_X86_SIMD
+    if (cpu_features & CPU_AVX2) {
+        ApplyChangesAVX2(parent, child, added, added_count, removed, removed_count);
+        return;
+    }
+#endif
+    ApplyChangesScalar(parent, child, added, added_count, removed, removed_count);
+}
+
+/**
+ * Computes both accumulators of a position from scratch
+ * Only needed at the root; moves below it use NNUEUpdate.
+ * @param game Position
+ * @param accumulator Output
+ */
+void NNUERefresh(const GameState* game, NNUEAccumulator* accumulator) {
+    const unsigned long long boards[4] = { game->red_pieces, game->red_kings, game->black_pieces, game->black_kings };
+    for (int perspective = 0; perspective < 2; perspective++) {
+        int features[32];
+        int count = 0;
+        for (int i = 0; i < 4; i++) {
+            int is_red = i < 2;
+            unsigned long long pieces = boards[i];
+            int pos;
+            FOR_EACH_BIT(pos, pieces) {
+                features[count++] = NNUEFeature(perspective, is_red == (perspective == 0), i & 1, POS_TO_SQUARE32(pos));
+            }
+        }
+        ApplyChanges(network->feature_biases, accumulator->values[perspective], features, count, NULL, 0);
+    }
+}
+
+/**
+ * Derives a child's accumulators from its parent's
+ * The move's piece changes are the same ones DoMove and MovePiece/
+ * CapturePiece make to the bitboards: the mover leaves its origin, appears
+ * on its destination (crowned if promoted) and every captured piece is
+ * removed. Only those feature columns are added or subtracted.
+ * @param parent Accumulators before the move
+ * @param child Output: accumulators after the move
+ * @param mover Side making the move (0 = Red, 1 = Black)
+ * @param move Move being played
+ */
+void NNUEUpdate(const NNUEAccumulator* parent, NNUEAccumulator* child, int mover, const Move* move) {
+    int was_king = (move->flags & MOVE_KING) != 0;
+    int is_king = was_king || (move->flags & MOVE_PROMOTION);
+
+    for (int perspective = 0; perspective < 2; perspective++) {
+        int is_own = perspective == mover;
+        int added[1];
+        int removed[MAX_CHANGES];
+        int removed_count = 0;
+
+        added[0] = NNUEFeature(perspective, is_own, is_king, POS_TO_SQUARE32(move->to));
+        removed[removed_count++] = NNUEFeature(perspective, is_own, was_king, POS_TO_SQUARE32(move->from));
+        unsigned long long captured = move->captured;
+        int pos;
+        FOR_EACH_BIT(pos, captured) {
+            int captured_king = ((1ULL << pos) & move->captured_kings) != 0;
+            removed[removed_count++] = NNUEFeature(perspective, !is_own, captured_king, POS_TO_SQUARE32(pos));
+        }
+        ApplyChanges(parent->values[perspective], child->values[perspective], added, 1, removed, removed_count);
+    }
+}
+
+/**
+ * Scores a position from its accumulators
+ * @param accumulator Accumulators of the position
+ * @param side_to_move 0 = Red, 1 = Black
+ * @return Score in centi-men from the side to move's point of view
+ */
+int NNUEEvaluate(const NNUEAccumulator* accumulator, int side_to_move) {
+    const short* us = accumulator->values[side_to_move];
+    const short* them = accumulator->values[side_to_move ^ 1];
+    int dot;
+#ifdef HAVE_X86_SIMD
+    if (cpu_features & CPU_AVX2) {
+        dot = OutputDotAVX2(us, them);
+    } else {
+        dot = OutputDotScalar(us, them);
+    }
+#else
+    dot = OutputDotScalar(us, them);
+#endif
+
+    long long score = ((long long)dot + network->output_bias) * network->output_scale / (NNUE_QA * NNUE_QB);
+    if (score > NNUE_MAX_SCORE) return NNUE_MAX_SCORE;
+    if (score < -NNUE_MAX_SCORE) return -NNUE_MAX_SCORE;
+    return (int)score;
+}
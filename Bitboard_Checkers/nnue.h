@@ -0,0 +1,47 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+
+// Network shape: 128 piece-square inputs per perspective (own man, own king,
+// opponent man, opponent king on 32 squares) -> NNUE_HIDDEN accumulator
+// units per perspective -> clipped ReLU -> one output
+#define NNUE_FEATURES 128
+#define NNUE_HIDDEN   128
+
+// Quantization: accumulator units are scaled by NNUE_QA (1.0 == 127, the
+// ReLU clip), output weights by NNUE_QB
+#define NNUE_QA 127
+#define NNUE_QB 64
+
+// First-layer sums for both perspectives (0 = Red, 1 = Black)
+typedef struct {
+    short values[2][NNUE_HIDDEN] __attribute__((aligned(64)));
+} NNUEAccumulator;
+
+// Quantized parameters as stored in a weights file
+typedef struct {
+    short feature_weights[NNUE_FEATURES][NNUE_HIDDEN] __attribute__((aligned(64)));
+    short feature_biases[NNUE_HIDDEN] __attribute__((aligned(64)));
+    signed char output_weights[2 * NNUE_HIDDEN] __attribute__((aligned(64)));  // Side to move's half first
+    int output_bias;
+    int output_scale;       // Score = (dot + output_bias) * output_scale / (NNUE_QA * NNUE_QB)
+} NNUENetwork;
+
+// Loading the network used by the search
+FileStatus NNUELoad(const char* filename);
+FileStatus NNUESave(const NNUENetwork* network, const char* filename);
+void NNUEUnload(void);
+int NNUEEnabled(void);
+
+// Feature index of a piece as seen from one perspective
+int NNUEFeature(int perspective, int is_own, int is_king, int square32);
+
+// Accumulator maintenance and inference with the loaded network
+void NNUERefresh(const GameState* game, NNUEAccumulator* accumulator);
+void NNUEUpdate(const NNUEAccumulator* parent, NNUEAccumulator* child, int mover, const Move* move);
+int NNUEEvaluate(const NNUEAccumulator* accumulator, int side_to_move);
+
+#endif // NNUE_H
@@ -0,0 +1,355 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "archive.h"
+#include "bitops.h"
+#include "board.h"
+#include "board32.h"
+#include "eval.h"
+#include "game.h"
+#include "movegen.h"
+#include "nnue.h"
+
+// Centi-men per unit of the network's output (logit of the expected result)
+#define SCORE_SCALE 200.0f
+
+// Opening plies skipped in every game (they are mostly the same positions)
+#define SKIP_PLIES 4
+
+// Most active features per perspective (one per piece)
+#define MAX_ACTIVE 24
+
+// One training position with its target expected result for the side to move
+typedef struct {
+    unsigned long long red_pieces;
+    unsigned long long red_kings;
+    unsigned long long black_pieces;
+    unsigned long long black_kings;
+    int current_player;
+    float target;
+} Sample;
+
+// Floating-point copy of the network being trained
+typedef struct {
+    float feature_weights[NNUE_FEATURES][NNUE_HIDDEN];
+    float feature_biases[NNUE_HIDDEN];
+    float output_weights[2 * NNUE_HIDDEN];
+    float output_bias;
+} FloatNetwork;
+
+static FloatNetwork net;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long long NextRandom(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static float RandomUniform(unsigned long long* state, float range) {
+    return ((NextRandom(state) >> 40) / (float)(1 << 24) * 2.0f - 1.0f) * range;
+}
+
+static float Sigmoid(float x) {
+    return 1.0f / (1.0f + expf(-x));
+}
+
+// Active features of a sample for one perspective
+static int ActiveFeatures(const Sample* sample, int perspective, int* features) {
+    const unsigned long long boards[4] = { sample->red_pieces, sample->red_kings,
+                                           sample->black_pieces, sample->black_kings };
+    int count = 0;
+    for (int i = 0; i < 4; i++) {
+        unsigned long long pieces = boards[i];
+        int pos;
+        FOR_EACH_BIT(pos, pieces) {
+            features[count++] = NNUEFeature(perspective, (i < 2) == (perspective == 0), i & 1, POS_TO_SQUARE32(pos));
+        }
+    }
+    return count;
+}
+
+/**
+ * Collects quiet positions from every game of an archive
+ * Targets blend the game's result with the hand-written evaluation, which
+ * gives the network a smooth starting signal that the results then refine.
+ * @return Number of samples now in the array, or -1 if the archive cannot be read
+ */
+static long long CollectSamples(const char* path, Sample** samples, long long count, long long* capacity,
+                                long long limit, float lambda) {
+    Archive archive;
+    if (ArchiveOpen(&archive, path) != FILE_OK) return -1;
+
+    GameRecord* record = malloc(sizeof(GameRecord));
+    for (unsigned long long n = 0; n < archive.count && count < limit; n++) {
+        if (!ArchiveGetGame(&archive, n, record) || record->result == RESULT_NONE) continue;
+
+        GameState game;
+        RecordReplay(record, 0, &game);
+        for (int ply = 0; ply < record->ply_count && count < limit; ply++) {
+            MoveList list;
+            GenerateMoves(&game, &list);
+            const Move* move = FindEncodedMove(&list, record->moves[ply]);
+            if (move == NULL) break;
+
+            // Only quiet positions are ever evaluated by the search
+            if (ply >= SKIP_PLIES && list.moves[0].captured == 0ULL) {
+                float result = 0.5f;
+                if (record->result == RESULT_RED_WINS) result = game.current_player == 0 ? 1.0f : 0.0f;
+                if (record->result == RESULT_BLACK_WINS) result = game.current_player == 1 ? 1.0f : 0.0f;
+
+                if (count == *capacity) {
+                    *capacity = *capacity ? *capacity * 2 : 1 << 16;
+                    *samples = realloc(*samples, *capacity * sizeof(Sample));
+                    if (*samples == NULL) {
+                        printf("Error: Out of memory after %lld positions!\n", count);
+                        exit(1);
+                    }
+                }
+                Sample* sample = &(*samples)[count++];
+                sample->red_pieces = game.red_pieces;
+                sample->red_kings = game.red_kings;
+                sample->black_pieces = game.black_pieces;
+                sample->black_kings = game.black_kings;
+                sample->current_player = game.current_player;
+                sample->target = lambda * Sigmoid(Evaluate(&game) / SCORE_SCALE) + (1.0f - lambda) * result;
+            }
+            DoMove(&game, move);
+        }
+    }
+    free(record);
+    ArchiveClose(&archive);
+    return count;
+}
+
+// Forward pass; fills the accumulators (before clipping) and returns the output logit
+static float Forward(const Sample* sample, float* us, float* them, int* features, int* counts) {
+    int side = sample->current_player;
+    float* accumulators[2] = { side == 0 ? us : them, side == 0 ? them : us };
+    for (int perspective = 0; perspective < 2; perspective++) {
+        int* active = features + perspective * MAX_ACTIVE;
+        counts[perspective] = ActiveFeatures(sample, perspective, active);
+        float* acc = accumulators[perspective];
+        memcpy(acc, net.feature_biases, sizeof(net.feature_biases));
+        for (int i = 0; i < counts[perspective]; i++) {
+            for (int j = 0; j < NNUE_HIDDEN; j++) acc[j] += net.feature_weights[active[i]][j];
+        }
+    }
+
+    float out = net.output_bias;
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        out += net.output_weights[j] * fminf(fmaxf(us[j], 0.0f), 1.0f);
+        out += net.output_weights[NNUE_HIDDEN + j] * fminf(fmaxf(them[j], 0.0f), 1.0f);
+    }
+    return out;
+}
+
+// One stochastic gradient step on squared error of the predicted result; returns the loss
+static float TrainSample(const Sample* sample, float rate) {
+    float us[NNUE_HIDDEN], them[NNUE_HIDDEN];
+    int features[2 * MAX_ACTIVE];
+    int counts[2];
+    float prediction = Sigmoid(Forward(sample, us, them, features, counts));
+    float error = prediction - sample->target;
+    float gradient = 2.0f * error * prediction * (1.0f - prediction);
+
+    float us_gradient[NNUE_HIDDEN], them_gradient[NNUE_HIDDEN];
+    const float weight_limit = 127.0f / NNUE_QB;    // Output weights must fit int8 after scaling
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        float* w_us = &net.output_weights[j];
+        float* w_them = &net.output_weights[NNUE_HIDDEN + j];
+        us_gradient[j] = us[j] > 0.0f && us[j] < 1.0f ? gradient * *w_us : 0.0f;
+        them_gradient[j] = them[j] > 0.0f && them[j] < 1.0f ? gradient * *w_them : 0.0f;
+        *w_us = fminf(fmaxf(*w_us - rate * gradient * fminf(fmaxf(us[j], 0.0f), 1.0f), -weight_limit), weight_limit);
+        *w_them = fminf(fmaxf(*w_them - rate * gradient * fminf(fmaxf(them[j], 0.0f), 1.0f), -weight_limit), weight_limit);
+    }
+    net.output_bias -= rate * gradient;
+
+    int side = sample->current_player;
+    for (int perspective = 0; perspective < 2; perspective++) {
+        const float* acc_gradient = perspective == side ? us_gradient : them_gradient;
+        const int* active = features + perspective * MAX_ACTIVE;
+        for (int i = 0; i < counts[perspective]; i++) {
+            for (int j = 0; j < NNUE_HIDDEN; j++) net.feature_weights[active[i]][j] -= rate * acc_gradient[j];
+        }
+        for (int j = 0; j < NNUE_HIDDEN; j++) net.feature_biases[j] -= rate * acc_gradient[j];
+    }
+    return error * error;
+}
+
+// Mean squared error over a range of samples without training
+static double Validate(const Sample* samples, long long start, long long end) {
+    float us[NNUE_HIDDEN], them[NNUE_HIDDEN];
+    int features[2 * MAX_ACTIVE];
+    int counts[2];
+    double loss = 0;
+    for (long long i = start; i < end; i++) {
+        float error = Sigmoid(Forward(&samples[i], us, them, features, counts)) - samples[i].target;
+        loss += error * error;
+    }
+    return end > start ? loss / (end - start) : 0;
+}
+
+// Rounds value * scale to the nearest integer in [-limit, limit], counting values that had to be clamped
+static long QuantizeValue(float value, float scale, long limit, long long* clamped) {
+    long rounded = lrintf(value * scale);
+    if (rounded > limit || rounded < -limit) {
+        (*clamped)++;
+        return rounded > limit ? limit : -limit;
+    }
+    return rounded;
+}
+
+// Rounds the float network into the int16/int8 file format
+// @return Number of weights outside the integer range (clamped to its ends)
+static long long Quantize(NNUENetwork* quantized) {
+    long long clamped = 0;
+    for (int f = 0; f < NNUE_FEATURES; f++) {
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            quantized->feature_weights[f][j] = (short)QuantizeValue(net.feature_weights[f][j], NNUE_QA,
+                                                                    SHRT_MAX, &clamped);
+        }
+    }
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        quantized->feature_biases[j] = (short)QuantizeValue(net.feature_biases[j], NNUE_QA, SHRT_MAX, &clamped);
+    }
+    for (int k = 0; k < 2 * NNUE_HIDDEN; k++) {
+        quantized->output_weights[k] = (signed char)QuantizeValue(net.output_weights[k], NNUE_QB, SCHAR_MAX,
+                                                                  &clamped);
+    }
+    quantized->output_bias = (int)QuantizeValue(net.output_bias, NNUE_QA * NNUE_QB, INT_MAX / 2, &clamped);
+    quantized->output_scale = (int)SCORE_SCALE;
+    return clamped;
+}
+
+// Compares the quantized network, as the search runs it, with the float one
+static double QuantizationError(const Sample* samples, long long count) {
+    float us[NNUE_HIDDEN], them[NNUE_HIDDEN];
+    int features[2 * MAX_ACTIVE];
+    int counts[2];
+    double total = 0;
+    long long checked = count < 10000 ? count : 10000;
+    for (long long i = 0; i < checked; i++) {
+        const Sample* sample = &samples[i];
+        GameState game = { sample->red_pieces, sample->red_kings, sample->black_pieces, sample->black_kings,
+                           0, sample->current_player, 0 };
+        NNUEAccumulator accumulator;
+        NNUERefresh(&game, &accumulator);
+        float expected = Forward(sample, us, them, features, counts) * SCORE_SCALE;
+        total += fabs(NNUEEvaluate(&accumulator, sample->current_player) - expected);
+    }
+    return checked > 0 ? total / checked : 0;
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    const char* output = NULL;
+    const char* inputs[64];
+    int input_count = 0;
+    int epochs = 10;
+    long long limit = 4000000;
+    float lambda = 0.5f;
+    float rate = 0.01f;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--epochs") == 0 && has_value) {
+            epochs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--positions") == 0 && has_value) {
+            limit = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--lambda") == 0 && has_value) {
+            lambda = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && has_value) {
+            rate = (float)atof(argv[++i]);
+        } else if (output == NULL) {
+            output = argv[i];
+        } else if (input_count < 64) {
+            inputs[input_count++] = argv[i];
+        }
+    }
+
+    if (output == NULL || input_count == 0 || epochs <= 0 || limit <= 0 || lambda < 0 || lambda > 1 || rate <= 0) {
+        printf("Usage: %s <output.nnue> <archive>... [--epochs N] [--positions N] [--lambda L] [--rate R]\n", argv[0]);
+        printf("Trains an evaluation network on the games of self-play archives.\n");
+        printf("Targets are lambda * hand evaluation + (1 - lambda) * game result (default 0.5).\n");
+        return 1;
+    }
+
+    Sample* samples = NULL;
+    long long count = 0, capacity = 0;
+    for (int i = 0; i < input_count; i++) {
+        long long collected = CollectSamples(inputs[i], &samples, count, &capacity, limit, lambda);
+        if (collected < 0) {
+            printf("Error: Could not read archive '%s'!\n", inputs[i]);
+            return 1;
+        }
+        count = collected;
+    }
+    if (count < 100) {
+        printf("Error: Only %lld usable positions; play more games first!\n", count);
+        return 1;
+    }
+
+    unsigned long long rng = 1;
+    for (long long i = count - 1; i > 0; i--) {
+        long long j = (long long)(NextRandom(&rng) % (unsigned long long)(i + 1));
+        Sample swap = samples[i];
+        samples[i] = samples[j];
+        samples[j] = swap;
+    }
+    long long validation = count / 20;
+    long long training = count - validation;
+    printf("Positions: %lld training, %lld validation\n", training, validation);
+
+    for (int f = 0; f < NNUE_FEATURES; f++) {
+        for (int j = 0; j < NNUE_HIDDEN; j++) net.feature_weights[f][j] = RandomUniform(&rng, 0.1f);
+    }
+    for (int j = 0; j < NNUE_HIDDEN; j++) net.feature_biases[j] = 0.25f;
+    for (int k = 0; k < 2 * NNUE_HIDDEN; k++) net.output_weights[k] = RandomUniform(&rng, 0.1f);
+
+    printf("Epoch   Train loss   Valid loss     Time\n");
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        double start = Now();
+        double loss = 0;
+        for (long long i = validation; i < count; i++) {
+            long long j = i + (long long)(NextRandom(&rng) % (unsigned long long)(count - i));
+            Sample swap = samples[i];
+            samples[i] = samples[j];
+            samples[j] = swap;
+            loss += TrainSample(&samples[i], rate);
+        }
+        printf("%5d %12.6f %12.6f %7.1fs\n", epoch, loss / training, Validate(samples, 0, validation), Now() - start);
+        fflush(stdout);
+        rate *= 0.8f;
+    }
+
+    NNUENetwork* quantized = aligned_alloc(64, sizeof(NNUENetwork));
+    if (quantized == NULL) {
+        printf("Error: Out of memory!\n");
+        return 1;
+    }
+    long long clamped = Quantize(quantized);
+    if (clamped > 0) {
+        printf("Warning: %lld weights were outside the int16/int8 range and were clamped\n", clamped);
+    }
+    if (NNUESave(quantized, output) != FILE_OK || NNUELoad(output) != FILE_OK) {
+        printf("Error: Could not write '%s'!\n", output);
+        return 1;
+    }
+    printf("Network written to '%s' (quantization error %.2f centi-men)\n", output,
+           QuantizationError(samples, validation));
+
+    free(quantized);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "notation.h"
+#include "board.h"
+#include "zobrist.h"
+
+// Appends the landing squares of a capture after square; returns 1 once they reach to
+static int WriteCapturePath(int square, int to, unsigned long long remaining, char* text) {
+    if (remaining == 0) return square == to;
+
+    int row = square / 8, col = square % 8;
+    for (int dr = -1; dr <= 1; dr += 2) {
+        for (int dc = -1; dc <= 1; dc += 2) {
+            if (!IsValidPosition(row + 2 * dr, col + 2 * dc)) continue;
+            unsigned long long victim = 1ULL << GetPosition(row + dr, col + dc);
+            if (!(remaining & victim)) continue;
+            sprintf(text, "-%d%d", row + 2 * dr, col + 2 * dc);
+            if (WriteCapturePath(GetPosition(row + 2 * dr, col + 2 * dc), to, remaining & ~victim, text + 3)) {
+                return 1;
+            }
+        }
+    }
+    *text = '\0';
+    return 0;
+}
+
+// Formats a move of game's side to move (text holds MOVE_TEXT_SIZE characters)
+void FormatMove(const GameState* game, const Move* move, char* text) {
+    MoveList list;
+    GenerateMoves(game, &list);
+    int same_ends = 0;
+    for (int i = 0; i < list.count; i++) {
+        same_ends += list.moves[i].from == move->from && list.moves[i].to == move->to;
+    }
+
+    sprintf(text, "%d%d", move->from / 8, move->from % 8);
+    if (same_ends > 1 && WriteCapturePath(move->from, move->to, move->captured, text + 2)) return;
+    sprintf(text + 2, "-%d%d", move->to / 8, move->to % 8);
+}
+
+/**
+ * Reads a move in protocol notation
+ * The end squares are enough unless several capture sequences join them
+ * (FormatMove then writes the landing squares, which pick one exactly).
+ * @param game Position the move is played in
+ * @param text Squares as row/column digit pairs separated by '-' or 'x'
+ * @return Matching generated move, or NULL if there is none or the end squares are ambiguous
+ */
+const Move* ParseMove(const GameState* game, const char* text, MoveList* list) {
+    int squares[16];
+    int count = 0;
+    for (const char* c = text; *c != '\0'; ) {
+        if (c[0] < '0' || c[0] > '7' || c[1] < '0' || c[1] > '7' || count == 16) return NULL;
+        squares[count++] = GetPosition(c[0] - '0', c[1] - '0');
+        c += 2;
+        if (*c == '-' || *c == 'x') c++;
+    }
+    if (count < 2) return NULL;
+
+    unsigned long long captured = 0ULL;
+    for (int i = 1; i < count && count > 2; i++) {
+        captured |= 1ULL << ((squares[i - 1] + squares[i]) / 2);
+    }
+
+    GenerateMoves(game, list);
+    if (count == 2) return FindMove(list, squares[0], squares[1], NULL);
+    return FindCapture(list, squares[0], squares[count - 1], captured);
+}
+
+/**
+ * Reads one save-file field ("RED_KINGS=0000000000000002") into game
+ * @param game Position being set up
+ * @param token One KEY=VALUE field
+ * @return The field's bit in POSITION_FIELDS_ALL, or 0 if token is not one
+ */
+int ParsePositionField(GameState* game, const char* token) {
+    if (sscanf(token, "RED_PIECES=%llX", &game->red_pieces) == 1) return 0x01;
+    if (sscanf(token, "RED_KINGS=%llX", &game->red_kings) == 1) return 0x02;
+    if (sscanf(token, "BLACK_PIECES=%llX", &game->black_pieces) == 1) return 0x04;
+    if (sscanf(token, "BLACK_KINGS=%llX", &game->black_kings) == 1) return 0x08;
+    if (sscanf(token, "CURRENT_PLAYER=%d", &game->current_player) == 1) return 0x10;
+    return 0;
+}
+
+// Returns 1 if every piece stands alone on a dark square and the side to move is 0 or 1
+int IsValidSetup(const GameState* game) {
+    unsigned long long boards[4] = { game->red_pieces, game->red_kings, game->black_pieces, game->black_kings };
+    unsigned long long occupied = 0ULL;
+    for (int i = 0; i < 4; i++) {
+        if (occupied & boards[i]) return 0;
+        occupied |= boards[i];
+    }
+    return !(occupied & ~PLAYABLE_SQUARES) && (game->current_player == 0 || game->current_player == 1);
+}
+
+// Appends one record to a growing position list; returns 0 when out of memory
+static int AddPosition(PositionEntry** entries, int* count, int* capacity,
+                       const GameState* game, const char* error) {
+    if (*count == *capacity) {
+        int grown_capacity = *capacity > 0 ? *capacity * 2 : 1024;
+        PositionEntry* grown = realloc(*entries, grown_capacity * sizeof(PositionEntry));
+        if (grown == NULL) return 0;
+        *entries = grown;
+        *capacity = grown_capacity;
+    }
+
+    PositionEntry* entry = &(*entries)[(*count)++];
+    memset(entry, 0, sizeof(*entry));
+    entry->error = error;
+    if (error == NULL) {
+        entry->game = *game;
+        entry->game.game_over = 0;
+        entry->game.hash = ComputeHash(game);
+        if (!IsValidSetup(game)) entry->error = "illegal position";
+    }
+    return 1;
+}
+
+/**
+ * Reads a file of positions
+ * Each position is given by its save-file fields, either one per line as
+ * SaveGame writes them (a record ends at a blank line or once all five fields
+ * are read), all on one line, or as five bare values:
+ *   <red pieces> <red kings> <black pieces> <black kings> <side to move>
+ * '#' starts a comment. Records that cannot be used still get an entry with
+ * the reason set, so entry n always belongs to the file's n-th record.
+ * @param path File to read
+ * @param entries Output: malloc'd records (free with free())
+ * @param count Output: number of records
+ * @return FILE_OK, or FILE_ERROR_OPEN if the file cannot be read
+ */
+FileStatus LoadPositions(const char* path, PositionEntry** entries, int* count) {
+    *entries = NULL;
+    *count = 0;
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return FILE_ERROR_OPEN;
+
+    char line[POSITION_LINE_SIZE];
+    GameState game;
+    int capacity = 0;
+    int fields = 0;
+    int ok = 1;
+    memset(&game, 0, sizeof(game));
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        // Five bare values
+        GameState bare;
+        memset(&bare, 0, sizeof(bare));
+        char extra;
+        if (sscanf(line, "%llx %llx %llx %llx %d %c", &bare.red_pieces, &bare.red_kings,
+                   &bare.black_pieces, &bare.black_kings, &bare.current_player, &extra) == 5) {
+            if (fields != 0) ok = AddPosition(entries, count, &capacity, NULL, "incomplete position");
+            fields = 0;
+            ok = ok && AddPosition(entries, count, &capacity, &bare, NULL);
+            continue;
+        }
+
+        char* token = strtok(line, " \t");
+        if (token == NULL && fields != 0) {
+            ok = AddPosition(entries, count, &capacity, NULL, "incomplete position");
+            fields = 0;
+        }
+        for (; ok && token != NULL; token = strtok(NULL, " \t")) {
+            if (strncmp(token, "GAME_OVER=", 10) == 0) continue;
+
+            // A repeated field starts the next record
+            GameState next = game;
+            int field = ParsePositionField(&next, token);
+            if (field == 0) {
+                ok = AddPosition(entries, count, &capacity, NULL, "unreadable position");
+                fields = 0;
+                memset(&game, 0, sizeof(game));
+                break;
+            }
+            if (fields & field) {
+                ok = AddPosition(entries, count, &capacity, NULL, "incomplete position");
+                fields = 0;
+                memset(&next, 0, sizeof(next));
+                ParsePositionField(&next, token);
+            }
+            game = next;
+            fields |= field;
+            if (fields == POSITION_FIELDS_ALL) {
+                ok = AddPosition(entries, count, &capacity, &game, NULL);
+                fields = 0;
+                memset(&game, 0, sizeof(game));
+            }
+        }
+    }
+    if (ok && fields != 0) ok = AddPosition(entries, count, &capacity, NULL, "incomplete position");
+    fclose(file);
+
+    if (!ok) {
+        free(*entries);
+        *entries = NULL;
+        *count = 0;
+        return FILE_ERROR_OPEN;
+    }
+    return FILE_OK;
+}
@@ -0,0 +1,34 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+
+// Text form of moves used by the engine protocol and the batch tools:
+// row and column digits, from-to ("21-30"). A capture that shares both end
+// squares with another lists every landing square ("21-43-65").
+
+// Longest move text, terminator included
+#define MOVE_TEXT_SIZE 64
+
+void FormatMove(const GameState* game, const Move* move, char* text);
+const Move* ParseMove(const GameState* game, const char* text, MoveList* list);
+
+// Positions are written as the save-file bitboard fields (RED_PIECES=<hex> ...)
+#define POSITION_FIELDS_ALL 0x1F
+
+int ParsePositionField(GameState* game, const char* token);
+int IsValidSetup(const GameState* game);
+
+// Position files: one record per position, see LoadPositions
+#define POSITION_LINE_SIZE 4096
+
+typedef struct {
+    GameState game;
+    const char* error;                  // Why the record is not a usable position, or NULL
+} PositionEntry;
+
+FileStatus LoadPositions(const char* path, PositionEntry** entries, int* count);
+
+#endif // NOTATION_H
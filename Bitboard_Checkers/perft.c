@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitops.h"
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+#include "stats.h"
+#include "tt.h"
+
+// Returns a monotonic timestamp in seconds
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Set when a transposition table was requested on the command line
+static int use_hash = 0;
+
+/**
+ * Counts the leaf nodes of the game tree below a position
+ * The last ply is bulk counted: the size of the generated move list is the
+ * number of leaves, so leaf positions are never made. Subtree counts are
+ * shared through the transposition table when hashing is enabled.
+ * @param game Pointer to game state (restored on return)
+ * @param depth Remaining plies (>= 1)
+ * @return Number of leaf nodes at the given depth
+ */
+static unsigned long long Perft(GameState* game, int depth) {
+    MoveList list;
+    GenerateMoves(game, &list);
+    if (depth == 1) return list.count;
+
+    unsigned long long nodes = 0;
+    if (use_hash && TTProbePerft(game->hash, depth, &nodes)) return nodes;
+
+    for (int i = 0; i < list.count; i++) {
+        DoMove(game, &list.moves[i]);
+        nodes += Perft(game, depth - 1);
+        UndoMove(game, &list.moves[i]);
+    }
+
+    if (use_hash) TTStorePerft(game->hash, depth, nodes);
+    return nodes;
+}
+
+// Runs perft with a per-root-move breakdown and prints timing
+static void PerftDivide(GameState* game, int depth) {
+    MoveList list;
+    GenerateMoves(game, &list);
+
+    double start = Now();
+    unsigned long long total = 0;
+
+    for (int i = 0; i < list.count; i++) {
+        const Move* move = &list.moves[i];
+        unsigned long long nodes = 1;
+        if (depth > 1) {
+            DoMove(game, move);
+            nodes = Perft(game, depth - 1);
+            UndoMove(game, move);
+        }
+        total += nodes;
+        printf("  %d %d -> %d %d%s : %llu\n", move->from / 8, move->from % 8,
+               move->to / 8, move->to % 8, move->captured ? " (x)" : "", nodes);
+    }
+
+    double elapsed = Now() - start;
+    printf("\nDepth:      %d\n", depth);
+    printf("Root moves: %d\n", list.count);
+    printf("Nodes:      %llu\n", total);
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Nodes/sec:  %.0f\n", elapsed > 0 ? total / elapsed : 0.0);
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    const char* savefile = NULL;
+    int depth = 0;
+    int hash_mb = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hash_mb = atoi(argv[++i]);
+        } else if (depth == 0) {
+            depth = atoi(argv[i]);
+        } else if (savefile == NULL) {
+            savefile = argv[i];
+        } else {
+            depth = 0;
+            break;
+        }
+    }
+
+    if (depth < 1) {
+        printf("Usage: %s <depth> [savefile] [--hash MB]\n", argv[0]);
+        printf("Counts leaf nodes from the start position or a saved game.\n");
+        return 1;
+    }
+
+    GameState game;
+    InitializeGame(&game);
+    if (savefile != NULL && LoadGame(&game, savefile) != FILE_OK) {
+        printf("Error: Could not load '%s'!\n", savefile);
+        return 1;
+    }
+
+    if (hash_mb > 0) {
+        if (!TTInit(hash_mb)) {
+            printf("Error: Could not allocate %d MB for the hash table!\n", hash_mb);
+            return 1;
+        }
+        use_hash = 1;
+        printf("Hash table: %d MB\n", TTSizeMB());
+    }
+
+    PerftDivide(&game, depth);
+    if (StatsEnabled()) {
+        printf("\n");
+        StatsWriteReport(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,429 @@
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "protocol.h"
+#include "board.h"
+#include "book.h"
+#include "history.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "notation.h"
+#include "search.h"
+#include "tt.h"
+#include "zobrist.h"
+
+/*
+ * Commands, one per line (anything else is answered with "error ..."):
+ *   hello                       id lines, then "hellook"
+ *   isready                     "readyok" (answered while searching too)
+ *   newgame                     forget the hash table
+ *   position start [moves M...]
+ *   position RED_PIECES=<hex> RED_KINGS=<hex> BLACK_PIECES=<hex> BLACK_KINGS=<hex>
+ *            CURRENT_PLAYER=<0|1> [moves M...]      (fields as in save files)
+ *   go [depth N] [time MS] [nodes N] [infinite] [ponder]
+ *   stop                        end the search now and report its move
+ *   ponderhit                   the pondered move was played: go on with "time"
+ *   set threads N | set hash MB | set book FILE|off | set nnue FILE|off
+ *   quit
+ * Replies while searching, one per completed iteration:
+ *   info depth D score S nodes N nps X time MS pv M...
+ * where S is centi-men for the side to move, or "win P"/"loss P" in plies;
+ * the search always ends with "bestmove M [ponder M]" ("bestmove none" when
+ * there are no legal moves). Moves use the notation of notation.h.
+ */
+
+#define PROTOCOL_LINE_SIZE 4096
+
+// Engine state (the searcher and position are only touched by the reading thread
+// while no search runs)
+static Searcher* searcher = NULL;
+static GameState position;
+static GameHistory position_history;    // The moves of the last "position" command, for repetitions
+
+// The running search
+static pthread_t worker;
+static int searching = 0;
+static GameState search_position;
+static SearchLimits search_limits;
+static SearchResult search_result;
+static int ponder_time_ms = 0;          // Budget once "ponderhit" arrives
+static double deadline = 0;             // When the reading thread stops the search (0 = never)
+
+// Shared with the worker under state_lock
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+static int search_done = 0;
+static int hold_bestmove = 0;           // Infinite and ponder searches report only when told to
+static int bestmove_sent = 0;
+
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Writes one reply line; replies come from both threads
+static void Send(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&output_lock);
+    vprintf(format, args);
+    putchar('\n');
+    fflush(stdout);
+    pthread_mutex_unlock(&output_lock);
+    va_end(args);
+}
+
+// Search progress line for one completed iteration
+static void ReportIteration(const SearchResult* result, void* context) {
+    (void)context;
+    char line[PROTOCOL_LINE_SIZE];
+    int length;
+    if (result->score >= WIN_BOUND) {
+        length = snprintf(line, sizeof(line), "info depth %d score win %d", result->depth, WIN_SCORE - result->score);
+    } else if (result->score <= -WIN_BOUND) {
+        length = snprintf(line, sizeof(line), "info depth %d score loss %d", result->depth, WIN_SCORE + result->score);
+    } else {
+        length = snprintf(line, sizeof(line), "info depth %d score %d", result->depth, result->score);
+    }
+    length += snprintf(line + length, sizeof(line) - length, " nodes %llu nps %.0f time %.0f pv",
+                       result->nodes, result->elapsed > 0 ? result->nodes / result->elapsed : 0.0,
+                       result->elapsed * 1000);
+
+    GameState game = search_position;
+    for (int i = 0; i < result->pv_length && length < (int)sizeof(line) - 64; i++) {
+        char move[MOVE_TEXT_SIZE];
+        FormatMove(&game, &result->pv[i], move);
+        length += snprintf(line + length, sizeof(line) - length, " %s", move);
+        DoMove(&game, &result->pv[i]);
+    }
+    Send("%s", line);
+}
+
+// Final reply of a search (caller holds state_lock)
+static void SendBestMove(void) {
+    const SearchResult* result = &search_result;
+    if (!result->has_move) {
+        Send("bestmove none");
+    } else {
+        char best[MOVE_TEXT_SIZE], ponder[MOVE_TEXT_SIZE];
+        FormatMove(&search_position, &result->best_move, best);
+        if (result->pv_length > 1) {
+            GameState game = search_position;
+            DoMove(&game, &result->best_move);
+            FormatMove(&game, &result->pv[1], ponder);
+            Send("bestmove %s ponder %s", best, ponder);
+        } else {
+            Send("bestmove %s", best);
+        }
+    }
+    bestmove_sent = 1;
+}
+
+// Runs one search; reports its move unless an infinite or ponder search has to wait for the GUI
+static void* SearchWorker(void* arg) {
+    (void)arg;
+    SearcherBestMove(searcher, &search_position, &search_limits, &search_result);
+
+    pthread_mutex_lock(&state_lock);
+    search_done = 1;
+    if (!hold_bestmove) SendBestMove();
+    pthread_mutex_unlock(&state_lock);
+    return NULL;
+}
+
+// Stops the running search (if any), waits for it and makes sure its move was reported
+static void FinishSearch(void) {
+    if (!searching) return;
+
+    SearcherStop(searcher);
+    pthread_join(worker, NULL);
+    SearcherClearStop(searcher);
+
+    pthread_mutex_lock(&state_lock);
+    if (!bestmove_sent) SendBestMove();
+    pthread_mutex_unlock(&state_lock);
+
+    searching = 0;
+    deadline = 0;
+}
+
+// Input ended: a search with limits of its own runs to its end and a pondered
+// one that turned into a timed search to its deadline, so piped batches get
+// complete answers; only a search waiting for "stop" is stopped
+static void FinishAtEndOfInput(void) {
+    if (!searching) return;
+
+    pthread_mutex_lock(&state_lock);
+    int held = hold_bestmove;
+    pthread_mutex_unlock(&state_lock);
+    if (held) {
+        FinishSearch();
+        return;
+    }
+
+    if (deadline > 0) {
+        double remaining = deadline - Now();
+        if (remaining > 0) {
+            struct timespec wait = { (time_t)remaining, (long)((remaining - (time_t)remaining) * 1e9) };
+            while (nanosleep(&wait, &wait) != 0) {}
+        }
+        FinishSearch();
+        return;
+    }
+
+    pthread_join(worker, NULL);
+    searching = 0;
+}
+
+// Starts a search of the current position in the background
+static void StartSearch(char* arguments) {
+    SearchLimits limits;
+    memset(&limits, 0, sizeof(limits));
+    limits.report = ReportIteration;
+    int infinite = 0, ponder = 0;
+    for (char* token = strtok(arguments, " "); token != NULL; token = strtok(NULL, " ")) {
+        char* value = NULL;
+        if (strcmp(token, "infinite") == 0) {
+            infinite = 1;
+        } else if (strcmp(token, "ponder") == 0) {
+            ponder = 1;
+        } else if ((value = strtok(NULL, " ")) == NULL) {
+            Send("error go: %s needs a value", token);
+            return;
+        } else if (strcmp(token, "depth") == 0) {
+            limits.max_depth = atoi(value);
+        } else if (strcmp(token, "time") == 0) {
+            limits.time_ms = atoi(value);
+        } else if (strcmp(token, "nodes") == 0) {
+            limits.max_nodes = strtoull(value, NULL, 10);
+        } else {
+            Send("error go: unknown limit '%s'", token);
+            return;
+        }
+    }
+
+    // A ponder search runs unlimited; its time budget starts with "ponderhit"
+    ponder_time_ms = ponder ? limits.time_ms : 0;
+    if (infinite || ponder) {
+        limits.time_ms = 0;
+        limits.max_depth = 0;
+        limits.max_nodes = 0;
+    } else {
+        limits.use_book = BookSize() > 0;
+    }
+
+    limits.history = &position_history;
+    search_position = position;
+    search_limits = limits;
+    search_done = 0;
+    bestmove_sent = 0;
+    TTNewSearch();
+    hold_bestmove = infinite || ponder;
+    deadline = 0;
+    if (pthread_create(&worker, NULL, SearchWorker, NULL) != 0) {
+        Send("error go: cannot start the search thread");
+        return;
+    }
+    searching = 1;
+}
+
+// The pondered move was played: the search continues on the clock, or stops if it has none
+static void PonderHit(void) {
+    if (!searching) return;
+    if (ponder_time_ms <= 0) {
+        FinishSearch();
+        return;
+    }
+
+    pthread_mutex_lock(&state_lock);
+    hold_bestmove = 0;
+    if (search_done && !bestmove_sent) SendBestMove();
+    pthread_mutex_unlock(&state_lock);
+    deadline = Now() + ponder_time_ms / 1000.0;
+}
+
+// Parses "start" or the save-file bitboard fields, then plays the listed moves
+static void SetPosition(char* arguments) {
+    GameState game;
+    char* token = strtok(arguments, " ");
+    if (token != NULL && strcmp(token, "start") == 0) {
+        InitializeGame(&game);
+        token = strtok(NULL, " ");
+    } else {
+        memset(&game, 0, sizeof(game));
+        int fields = 0;
+        for (; token != NULL && strcmp(token, "moves") != 0; token = strtok(NULL, " ")) {
+            int field = ParsePositionField(&game, token);
+            if (field == 0 && strncmp(token, "GAME_OVER=", 10) != 0) {
+                Send("error position: unknown field '%s'", token);
+                return;
+            }
+            fields |= field;
+        }
+
+        if (fields != POSITION_FIELDS_ALL || !IsValidSetup(&game)) {
+            Send("error position: needs the five bitboard fields of a legal position");
+            return;
+        }
+        game.hash = ComputeHash(&game);
+    }
+
+    static GameHistory history;
+    HistoryStart(&history, &game);
+    if (token != NULL && strcmp(token, "moves") == 0) {
+        for (token = strtok(NULL, " "); token != NULL; token = strtok(NULL, " ")) {
+            MoveList list;
+            const Move* move = ParseMove(&history.position, token, &list);
+            if (move == NULL) {
+                Send("error position: illegal move '%s'", token);
+                return;
+            }
+            HistoryAddMove(&history, move);
+        }
+    } else if (token != NULL) {
+        Send("error position: unexpected '%s'", token);
+        return;
+    }
+    position = history.position;
+    position_history = history;
+}
+
+// Engine options; changing them stops a running search first
+static void SetOption(char* arguments) {
+    char* name = strtok(arguments, " ");
+    char* value = strtok(NULL, "");
+    if (name == NULL || value == NULL) {
+        Send("error set: usage set <threads|hash|book|nnue> <value>");
+        return;
+    }
+
+    FinishSearch();
+    if (strcmp(name, "threads") == 0) {
+        Searcher* replacement = atoi(value) > 0 ? SearcherCreate(atoi(value)) : NULL;
+        if (replacement == NULL) {
+            Send("error set: invalid thread count '%s'", value);
+            return;
+        }
+        SearcherFree(searcher);
+        searcher = replacement;
+    } else if (strcmp(name, "hash") == 0) {
+        if (atoi(value) <= 0 || !TTInit(atoi(value))) Send("error set: could not allocate %s MB", value);
+    } else if (strcmp(name, "book") == 0) {
+        if (strcmp(value, "off") == 0) {
+            BookClose();
+        } else if (BookInit(value) != FILE_OK) {
+            Send("error set: could not open book '%s'", value);
+        }
+    } else if (strcmp(name, "nnue") == 0) {
+        if (strcmp(value, "off") == 0) {
+            NNUEUnload();
+        } else if (NNUELoad(value) != FILE_OK) {
+            Send("error set: could not load network '%s'", value);
+        }
+    } else {
+        Send("error set: unknown option '%s'", name);
+    }
+}
+
+// Handles one command line; returns 0 on "quit"
+static int HandleCommand(char* line) {
+    char* command = strtok(line, " \t\r");
+    char* arguments = strtok(NULL, "\r");
+    if (arguments == NULL) arguments = "";
+    if (command == NULL) return 1;
+
+    if (strcmp(command, "quit") == 0) {
+        FinishSearch();
+        return 0;
+    } else if (strcmp(command, "hello") == 0) {
+        Send("id name BitBoard Checkers");
+        Send("id protocol 1");
+        Send("hellook");
+    } else if (strcmp(command, "isready") == 0) {
+        Send("readyok");
+    } else if (strcmp(command, "stop") == 0) {
+        FinishSearch();
+    } else if (strcmp(command, "ponderhit") == 0) {
+        PonderHit();
+    } else if (strcmp(command, "newgame") == 0) {
+        FinishSearch();
+        TTClear();
+        InitializeGame(&position);
+        HistoryStart(&position_history, &position);
+    } else if (strcmp(command, "position") == 0) {
+        FinishSearch();
+        SetPosition(arguments);
+    } else if (strcmp(command, "go") == 0) {
+        FinishSearch();
+        StartSearch(arguments);
+    } else if (strcmp(command, "set") == 0) {
+        SetOption(arguments);
+    } else {
+        Send("error unknown command '%s'", command);
+    }
+    return 1;
+}
+
+/**
+ * Serves the engine protocol until "quit" or end of input
+ * Searches run on a worker thread while this thread keeps reading, so
+ * "stop", "isready" and new positions are handled at once. Input is read
+ * with poll/read rather than stdio so the wait can also end at a ponder
+ * search's deadline.
+ * @return Exit status for the process
+ */
+int RunProtocol(void) {
+    searcher = SearcherCreate(1);
+    if (searcher == NULL) {
+        Send("error out of memory");
+        return 1;
+    }
+    InitializeGame(&position);
+    HistoryStart(&position_history, &position);
+
+    char buffer[PROTOCOL_LINE_SIZE];
+    size_t used = 0;
+    int running = 1;
+    while (running) {
+        int timeout = -1;
+        if (searching && deadline > 0) {
+            double remaining = deadline - Now();
+            timeout = remaining > 0 ? (int)(remaining * 1000) + 1 : 0;
+        }
+
+        struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+        int ready = poll(&input, 1, timeout);
+        if (ready < 0) continue;
+        if (ready == 0) {
+            FinishSearch();
+            continue;
+        }
+
+        ssize_t received = read(STDIN_FILENO, buffer + used, sizeof(buffer) - 1 - used);
+        if (received <= 0) break;
+        used += received;
+
+        // Handle every complete line; an over-long line is dropped
+        char* start = buffer;
+        char* end;
+        while (running && (end = memchr(start, '\n', buffer + used - start)) != NULL) {
+            *end = '\0';
+            running = HandleCommand(start);
+            start = end + 1;
+        }
+        used -= start - buffer;
+        memmove(buffer, start, used);
+        if (used == sizeof(buffer) - 1) used = 0;
+    }
+
+    FinishAtEndOfInput();
+    SearcherFree(searcher);
+    return 0;
+}
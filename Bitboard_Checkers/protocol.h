@@ -0,0 +1,8 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+// Machine-oriented engine mode: line commands on stdin, replies on stdout.
+// Returns the process exit status once "quit" is read or stdin closes.
+int RunProtocol(void);
+
+#endif // PROTOCOL_H
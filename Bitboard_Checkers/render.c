@@ -0,0 +1,382 @@
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include "render.h"
+#include "bitops.h"
+
+/**
+ * Allocates a frame buffer
+ * @param frame Frame to set up (empty)
+ * @param capacity Initial size in bytes; the buffer grows when a frame needs more
+ * @return 1 on success, 0 if the memory could not be allocated
+ */
+int FrameInit(Frame* frame, size_t capacity) {
+    frame->data = malloc(capacity);
+    frame->length = 0;
+    frame->capacity = frame->data != NULL ? capacity : 0;
+    return frame->data != NULL;
+}
+
+// Releases a frame buffer
+void FrameFree(Frame* frame) {
+    free(frame->data);
+    frame->data = NULL;
+    frame->length = 0;
+    frame->capacity = 0;
+}
+
+// Starts a new frame in the same buffer
+void FrameClear(Frame* frame) {
+    frame->length = 0;
+}
+
+// Makes room for bytes more; returns 0 if the buffer cannot grow
+static int FrameReserve(Frame* frame, size_t bytes) {
+    if (frame->length + bytes <= frame->capacity) return 1;
+    size_t capacity = frame->capacity > 0 ? frame->capacity : 1024;
+    while (frame->length + bytes > capacity) capacity *= 2;
+    char* data = realloc(frame->data, capacity);
+    if (data == NULL) return 0;
+    frame->data = data;
+    frame->capacity = capacity;
+    return 1;
+}
+
+// Appends text (dropped if the buffer cannot grow)
+void FrameAppend(Frame* frame, const char* text) {
+    size_t length = strlen(text);
+    if (!FrameReserve(frame, length)) return;
+    memcpy(frame->data + frame->length, text, length);
+    frame->length += length;
+}
+
+// Appends formatted text (dropped if the buffer cannot grow)
+void FramePrintf(Frame* frame, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(frame->data + frame->length, frame->capacity - frame->length, format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    // vsnprintf needs room for the terminator, which is not kept
+    if (frame->length + length >= frame->capacity) {
+        if (!FrameReserve(frame, length + 1)) return;
+        va_start(args, format);
+        vsnprintf(frame->data + frame->length, frame->capacity - frame->length, format, args);
+        va_end(args);
+    }
+    frame->length += length;
+}
+
+/**
+ * Writes a whole frame with as few write calls as the descriptor allows
+ * (one for a terminal), so it never appears half drawn
+ * @param frame Frame to write
+ * @param fd Destination, normally STDOUT_FILENO (flush stdio first)
+ * @return 1 on success, 0 on a write error
+ */
+int FrameWrite(const Frame* frame, int fd) {
+    size_t written = 0;
+    while (written < frame->length) {
+        ssize_t result = write(fd, frame->data + written, frame->length - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result < 0) return 0;
+        written += result;
+    }
+    return 1;
+}
+
+/**
+ * Composes the terminal game's board display
+ * @param frame Frame to append to
+ * @param game Position to show
+ */
+void RenderBoard(Frame* frame, const GameState* game) {
+    FrameAppend(frame, "\n");
+    FrameAppend(frame, "  ╔═══════════════════════════════╗\n");
+    FrameAppend(frame, "  ║  BITBOARD CHECKERS GAME       ║\n");
+    FrameAppend(frame, "  ╚═══════════════════════════════╝\n");
+    FrameAppend(frame, "\n    0   1   2   3   4   5   6   7\n");
+    FrameAppend(frame, "  ╔═══╦═══╦═══╦═══╦═══╦═══╦═══╦═══╗\n");
+
+    for (int row = 7; row >= 0; row--) {
+        FramePrintf(frame, "%d ║", row);
+
+        for (int col = 0; col < 8; col++) {
+            int pos = row * 8 + col;
+            int is_dark = (row + col) % 2 == 1;
+
+            if (GetBit(game->red_kings, pos)) {
+                FrameAppend(frame, " R̂ ");  // Red King
+            } else if (GetBit(game->red_pieces, pos)) {
+                FrameAppend(frame, " r ");   // Red piece
+            } else if (GetBit(game->black_kings, pos)) {
+                FrameAppend(frame, " B̂ ");  // Black King
+            } else if (GetBit(game->black_pieces, pos)) {
+                FrameAppend(frame, " b ");   // Black piece
+            } else if (is_dark) {
+                FrameAppend(frame, " · ");   // Empty dark square
+            } else {
+                FrameAppend(frame, "   ");   // Light square (not playable)
+            }
+
+            if (col < 7) FrameAppend(frame, "║");
+        }
+
+        FramePrintf(frame, "║ %d\n", row);
+
+        if (row > 0) {
+            FrameAppend(frame, "  ╠═══╬═══╬═══╬═══╬═══╬═══╬═══╬═══╣\n");
+        }
+    }
+
+    FrameAppend(frame, "  ╚═══╩═══╩═══╩═══╩═══╩═══╩═══╩═══╝\n");
+    FrameAppend(frame, "    0   1   2   3   4   5   6   7\n\n");
+
+    FrameAppend(frame, "  Legend: r=Red  R̂=Red King  b=Black  B̂=Black King  ·=Empty\n");
+    FramePrintf(frame, "  Current Player: %s\n", game->current_player == 0 ? "RED" : "BLACK");
+    FramePrintf(frame, "  Red Pieces: %d  Black Pieces: %d\n",
+                CountBits(game->red_pieces | game->red_kings),
+                CountBits(game->black_pieces | game->black_kings));
+}
+
+/**
+ * Works out how much of a grid fits on a terminal
+ * @param fd Terminal the grid is written to (80x24 is assumed if it is not one)
+ * @param games Games there are to show
+ * @param columns Output: games per screen row
+ * @return Games that fit (at least 1), leaving a line for the footer
+ */
+int GridFit(int fd, int games, int* columns) {
+    int width = 80, height = 24;
+    struct winsize size;
+    if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        width = size.ws_col;
+        height = size.ws_row;
+    }
+    *columns = width / GRID_CELL_WIDTH > 0 ? width / GRID_CELL_WIDTH : 1;
+    int rows = (height - 1) / GRID_CELL_HEIGHT > 0 ? (height - 1) / GRID_CELL_HEIGHT : 1;
+    if (*columns > games) *columns = games;
+    return games < *columns * rows ? games : *columns * rows;
+}
+
+/**
+ * Prepares an empty spectator grid
+ * @param grid Grid to set up
+ * @param count Games shown
+ * @param columns Games per screen row (at least 1)
+ * @return 1 on success, 0 if the memory could not be allocated
+ */
+int GridInit(SpectatorGrid* grid, int count, int columns) {
+    memset(grid, 0, sizeof(*grid));
+    grid->count = count;
+    grid->columns = columns > 0 ? columns : 1;
+    grid->shown = calloc(count, sizeof(GridCell));
+    if (grid->shown == NULL) return 0;
+    if (!FrameInit(&grid->frame, (size_t)count * GRID_CELL_WIDTH * GRID_CELL_HEIGHT * 2)) {
+        free(grid->shown);
+        grid->shown = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// Releases a spectator grid
+void GridFree(SpectatorGrid* grid) {
+    free(grid->shown);
+    grid->shown = NULL;
+    FrameFree(&grid->frame);
+}
+
+// Moves the cursor to a screen position (1-based)
+static void MoveCursor(Frame* frame, int y, int x) {
+    FramePrintf(frame, "\x1b[%d;%dH", y, x);
+}
+
+// Grid symbol of one square: r/b men, R/B kings, '.' empty dark square
+static char SquareSymbol(const GameState* game, int pos) {
+    unsigned long long bit = 1ULL << pos;
+    if (game->red_kings & bit) return 'R';
+    if (game->red_pieces & bit) return 'r';
+    if (game->black_kings & bit) return 'B';
+    if (game->black_pieces & bit) return 'b';
+    return (PLAYABLE_SQUARES & bit) ? '.' : ' ';
+}
+
+// Writes a title or status line, padded to clear the previous text
+static void DrawText(Frame* frame, int y, int x, const char* text) {
+    MoveCursor(frame, y, x);
+    FramePrintf(frame, "%-*.*s", GRID_TEXT_WIDTH, GRID_TEXT_WIDTH, text);
+}
+
+// Draws a whole cell with its top-left corner at y, x
+static void DrawCell(Frame* frame, int y, int x, const GridCell* cell) {
+    DrawText(frame, y, x, cell->title);
+    for (int row = 7; row >= 0; row--) {
+        char line[17];
+        for (int col = 0; col < 8; col++) {
+            line[col * 2] = SquareSymbol(&cell->game, row * 8 + col);
+            line[col * 2 + 1] = ' ';
+        }
+        line[16] = '\0';
+        MoveCursor(frame, y + 8 - row, x);
+        FrameAppend(frame, line);
+    }
+    DrawText(frame, y + 9, x, cell->status);
+}
+
+// Redraws only what differs between the cell on screen and its new contents
+static void UpdateCell(Frame* frame, int y, int x, const GridCell* shown, const GridCell* cell) {
+    if (strcmp(shown->title, cell->title) != 0) DrawText(frame, y, x, cell->title);
+
+    unsigned long long changed = (shown->game.red_pieces ^ cell->game.red_pieces) |
+                                 (shown->game.red_kings ^ cell->game.red_kings) |
+                                 (shown->game.black_pieces ^ cell->game.black_pieces) |
+                                 (shown->game.black_kings ^ cell->game.black_kings);
+    int pos;
+    FOR_EACH_BIT(pos, changed) {
+        MoveCursor(frame, y + 8 - pos / 8, x + (pos % 8) * 2);
+        FramePrintf(frame, "%c", SquareSymbol(&cell->game, pos));
+    }
+
+    if (strcmp(shown->status, cell->status) != 0) DrawText(frame, y + 9, x, cell->status);
+}
+
+/**
+ * Composes the next spectator frame
+ * The first frame clears the screen and draws everything; later frames
+ * contain only the changes since the previous one, and are empty when
+ * nothing changed.
+ * @param grid Grid (remembers what the terminal shows)
+ * @param cells Current contents, grid->count of them
+ * @param footer Line shown under the grid (e.g. overall progress)
+ * @return Frame to write out
+ */
+const Frame* GridRender(SpectatorGrid* grid, const GridCell* cells, const char* footer) {
+    Frame* frame = &grid->frame;
+    FrameClear(frame);
+    if (!grid->drawn) FrameAppend(frame, "\x1b[H\x1b[2J");
+
+    for (int i = 0; i < grid->count; i++) {
+        int y = 1 + (i / grid->columns) * GRID_CELL_HEIGHT;
+        int x = 1 + (i % grid->columns) * GRID_CELL_WIDTH;
+        if (grid->drawn) {
+            UpdateCell(frame, y, x, &grid->shown[i], &cells[i]);
+        } else {
+            DrawCell(frame, y, x, &cells[i]);
+        }
+        grid->shown[i] = cells[i];
+    }
+
+    int footer_row = 1 + (grid->count + grid->columns - 1) / grid->columns * GRID_CELL_HEIGHT;
+    if (!grid->drawn || strncmp(grid->footer, footer, sizeof(grid->footer) - 1) != 0) {
+        MoveCursor(frame, footer_row, 1);
+        FramePrintf(frame, "%s\x1b[K", footer);
+        snprintf(grid->footer, sizeof(grid->footer), "%s", footer);
+    }
+
+    // Leave the cursor after the footer rather than on the last square drawn
+    if (frame->length > 0) MoveCursor(frame, footer_row, (int)strlen(grid->footer) + 1);
+    grid->drawn = 1;
+    return frame;
+}
+
+/**
+ * Allocates the published games of count workers
+ * Until a worker publishes its first position its cell shows an empty
+ * board titled "Worker N" with the status "waiting".
+ * @param count Number of workers
+ * @return The games, or NULL if the memory could not be allocated
+ */
+LiveGame* LiveGamesCreate(int count) {
+    LiveGame* games = calloc(count, sizeof(LiveGame));
+    if (games == NULL) return NULL;
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_init(&games[i].lock, NULL);
+        snprintf(games[i].cell.title, sizeof(games[i].cell.title), "Worker %d", i + 1);
+        snprintf(games[i].cell.status, sizeof(games[i].cell.status), "waiting");
+    }
+    return games;
+}
+
+// Releases published games (no worker may still use them)
+void LiveGamesFree(LiveGame* games, int count) {
+    if (games == NULL) return;
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_destroy(&games[i].lock);
+    }
+    free(games);
+}
+
+/**
+ * Publishes a worker's position
+ * @param view The worker's game
+ * @param title Cell title, e.g. "Game 12"
+ * @param game Current position
+ * @param ply Plies played
+ * @param result Short result text once the game is over, NULL while it goes on
+ */
+void LiveGameShow(LiveGame* view, const char* title, const GameState* game, int ply, const char* result) {
+    pthread_mutex_lock(&view->lock);
+    view->cell.game = *game;
+    snprintf(view->cell.title, sizeof(view->cell.title), "%s", title);
+    if (result != NULL) {
+        snprintf(view->cell.status, sizeof(view->cell.status), "%s, ply %d", result, ply);
+    } else {
+        snprintf(view->cell.status, sizeof(view->cell.status), "ply %d, %s", ply,
+                 game->current_player == 0 ? "red" : "black");
+    }
+    pthread_mutex_unlock(&view->lock);
+}
+
+/**
+ * Shows the workers' games in a spectator grid on standard output
+ * The grid is refreshed every interval, whatever the move rate, and each
+ * refresh writes only what changed since the last one. The footer is asked
+ * for before the games are copied, so the last frame shows every game's end.
+ * @param games Published games, one per worker (as many as fit are shown)
+ * @param count Number of workers
+ * @param interval_ms Time between refreshes
+ * @param footer Writes the footer and says when to stop
+ * @param context Passed to footer
+ * @return 1 on success, 0 if the grid could not be allocated
+ */
+int Spectate(LiveGame* games, int count, int interval_ms, SpectatorFooter footer, void* context) {
+    int columns;
+    int shown = GridFit(STDOUT_FILENO, count, &columns);
+    SpectatorGrid grid;
+    GridCell* cells = malloc(shown * sizeof(GridCell));
+    if (cells == NULL || !GridInit(&grid, shown, columns)) {
+        free(cells);
+        return 0;
+    }
+
+    struct timespec interval = { interval_ms / 1000, (interval_ms % 1000) * 1000000L };
+    char text[sizeof(grid.footer)];
+    fflush(stdout);
+    for (;;) {
+        int last = footer(text, sizeof(text), context);
+        if (shown < count) {
+            size_t length = strlen(text);
+            snprintf(text + length, sizeof(text) - length, ", showing %d of %d workers", shown, count);
+        }
+        for (int i = 0; i < shown; i++) {
+            pthread_mutex_lock(&games[i].lock);
+            cells[i] = games[i].cell;
+            pthread_mutex_unlock(&games[i].lock);
+        }
+        FrameWrite(GridRender(&grid, cells, text), STDOUT_FILENO);
+
+        if (last) break;
+        nanosleep(&interval, NULL);
+    }
+
+    GridFree(&grid);
+    free(cells);
+    return 1;
+}
@@ -0,0 +1,72 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include "board.h"
+
+// Text of one screen update, composed in memory and written with a single
+// write call instead of one printf per square. The buffer is reused from
+// frame to frame and only grows when a frame is larger than any before.
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Frame;
+
+int FrameInit(Frame* frame, size_t capacity);
+void FrameFree(Frame* frame);
+void FrameClear(Frame* frame);
+void FrameAppend(Frame* frame, const char* text);
+void FramePrintf(Frame* frame, const char* format, ...) __attribute__((format(printf, 2, 3)));
+int FrameWrite(const Frame* frame, int fd);
+
+// The full board display of the terminal game
+void RenderBoard(Frame* frame, const GameState* game);
+
+// Spectator grid: many games side by side on a fixed screen layout. After
+// the first frame only the squares whose bits changed, and the text lines
+// that changed, are redrawn (ANSI cursor positioning).
+#define GRID_CELL_WIDTH 20                      // Board 16 columns wide plus the gap
+#define GRID_CELL_HEIGHT 11                     // Title, 8 board rows, status, gap
+#define GRID_TEXT_WIDTH (GRID_CELL_WIDTH - 2)   // Title and status characters shown
+#define GRID_TEXT_SIZE 32
+
+// One game as the grid shows it
+typedef struct {
+    GameState game;
+    char title[GRID_TEXT_SIZE];             // e.g. "Game 12" (cut to GRID_TEXT_WIDTH)
+    char status[GRID_TEXT_SIZE];            // e.g. "ply 45, red"
+} GridCell;
+
+typedef struct {
+    int count;
+    int columns;
+    int drawn;                              // 0 until the first full frame
+    GridCell* shown;                        // What the terminal shows now
+    char footer[256];
+    Frame frame;
+} SpectatorGrid;
+
+int GridFit(int fd, int games, int* columns);
+int GridInit(SpectatorGrid* grid, int count, int columns);
+void GridFree(SpectatorGrid* grid);
+const Frame* GridRender(SpectatorGrid* grid, const GridCell* cells, const char* footer);
+
+// A worker's current game as the spectator sees it: the worker publishes
+// with LiveGameShow, the spectator copies the cell under the lock
+typedef struct {
+    pthread_mutex_t lock;
+    GridCell cell;
+} LiveGame;
+
+LiveGame* LiveGamesCreate(int count);
+void LiveGamesFree(LiveGame* games, int count);
+void LiveGameShow(LiveGame* view, const char* title, const GameState* game, int ply, const char* result);
+
+// Writes the footer line under the grid; returns 1 when this frame is the last
+typedef int (*SpectatorFooter)(char* footer, size_t size, void* context);
+
+int Spectate(LiveGame* games, int count, int interval_ms, SpectatorFooter footer, void* context);
+
+#endif // RENDER_H
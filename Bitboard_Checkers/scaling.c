@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "board.h"
+#include "game.h"
+#include "search.h"
+#include "stats.h"
+#include "tt.h"
+
+// Opening moves played from the start position to get varied test positions
+#define POSITION_COUNT 4
+static const int OPENING_PLIES[POSITION_COUNT] = { 0, 4, 10, 16 };
+
+// Builds a test position by letting a quick search play the opening
+static void BuildPosition(GameState* game, int plies) {
+    SearchLimits limits = { .max_depth = 4 };
+    SearchResult result;
+
+    InitializeGame(game);
+    for (int i = 0; i < plies; i++) {
+        if (!SearchBestMove(game, &limits, &result)) break;
+        DoMove(game, &result.best_move);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    int time_ms = argc > 1 ? atoi(argv[1]) : 2000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int hash_mb = argc > 3 ? atoi(argv[3]) : 256;
+
+    if (time_ms <= 0 || max_threads <= 0 || hash_mb <= 0) {
+        printf("Usage: %s [time_ms] [max_threads] [hash_mb]\n", argv[0]);
+        printf("Measures search nodes/sec for 1, 2, 4, ... threads up to max_threads.\n");
+        return 1;
+    }
+    if (!TTInit(hash_mb)) {
+        printf("Error: Could not allocate %d MB for the hash table!\n", hash_mb);
+        return 1;
+    }
+
+    GameState positions[POSITION_COUNT];
+    SetSearchThreads(1);
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        BuildPosition(&positions[i], OPENING_PLIES[i]);
+    }
+
+    printf("Search scaling: %d ms per position, %d positions, %d MB hash\n\n",
+           time_ms, POSITION_COUNT, TTSizeMB());
+    printf("Threads   Nodes/sec    Speedup   Efficiency   Avg depth   Stack KB\n");
+
+    double base_nps = 0;
+    for (int count = 1; ; count *= 2) {
+        if (count > max_threads) count = max_threads;
+        if (!SetSearchThreads(count)) break;
+
+        unsigned long long nodes = 0;
+        double elapsed = 0;
+        int depth_sum = 0;
+        size_t arena_peak = 0, arena_size = 0;
+        for (int i = 0; i < POSITION_COUNT; i++) {
+            SearchLimits limits = { .time_ms = time_ms };
+            SearchResult result;
+            TTClear();
+            SearchBestMove(&positions[i], &limits, &result);
+            nodes += result.nodes;
+            elapsed += result.elapsed;
+            depth_sum += result.depth;
+            if (result.arena_peak > arena_peak) arena_peak = result.arena_peak;
+            arena_size = result.arena_size;
+        }
+
+        double nps = elapsed > 0 ? nodes / elapsed : 0;
+        if (count == 1) base_nps = nps;
+        double speedup = base_nps > 0 ? nps / base_nps : 0;
+        printf("%7d %11.0f %9.2fx %10.0f%% %11.1f %6zu/%zu\n", count, nps, speedup,
+               100.0 * speedup / count, (double)depth_sum / POSITION_COUNT,
+               arena_peak >> 10, arena_size >> 10);
+        fflush(stdout);
+        if (count == max_threads) break;
+    }
+    if (StatsEnabled()) {
+        printf("\n");
+        StatsWriteReport(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,743 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "search.h"
+#include "arena.h"
+#include "eval.h"
+#include "bitops.h"
+#include "book.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "stats.h"
+#include "tablebase.h"
+#include "tt.h"
+
+// Half-width of the first aspiration window around the previous score
+#define ASPIRATION_WINDOW 40
+
+// How often (in nodes) a thread polls the stop flag and publishes its node count
+#define CHECK_INTERVAL 255
+
+// How often the time-keeper thread wakes up
+#define TIMEKEEPER_INTERVAL_NS 1000000
+
+// Move ordering tiers
+#define ORDER_HASH    1000000000
+#define ORDER_CAPTURE  100000000
+#define ORDER_KILLER1   90000000
+#define ORDER_KILLER2   80000000
+
+// Search stack arena: at most one move list and its ordering scores are live
+// per ply, plus the triangular PV table, so this size can never run out
+#define NODE_BYTES (sizeof(MoveList) + MAX_MOVES * sizeof(int) + 2 * ARENA_ALIGN)
+#define PV_BYTES (MAX_PLY * (MAX_PLY + 1) / 2 * sizeof(Move) + MAX_PLY * ARENA_ALIGN)
+#define SEARCH_ARENA_SIZE (MAX_PLY * NODE_BYTES + PV_BYTES)
+
+// Per-thread working state (no I/O; only the TT and the stop flag are shared)
+typedef struct {
+    struct Searcher* searcher;          // Search this thread belongs to
+    int id;                             // 0 = main thread, which reports the result
+    GameState game;
+    MoveList root;
+    int root_depth;                     // Iteration currently being searched
+    unsigned long long nodes;
+    unsigned long long published_nodes; // Copy of nodes readable by other threads
+    int stopped;
+
+    int completed_depth;                // Last finished iteration (main thread only)
+    int score;
+
+    Move killers[MAX_PLY][2];           // Quiet moves that caused cutoffs at each ply
+    int history[64][64];                // Cutoff counts by from/to square
+
+    // Move lists, ordering scores and PV lines; nodes take their blocks from
+    // here and give them back on return, so no node ever calls malloc
+    Arena arena;
+    size_t iteration_mark;              // Arena top at the start of each iteration
+
+    Move* pv[MAX_PLY];                  // Triangular principal variation table (in the arena)
+    int pv_length[MAX_PLY];
+
+    // Keys of the game's quiet stretch before the root, then of each ply
+    // searched; keys[key_base + ply] is the position at ply
+    unsigned long long keys[DRAW_QUIET_PLIES + MAX_PLY + 1];
+    int key_base;
+    int quiet_plies[MAX_PLY + 1];       // Plies since a capture or man move, per ply
+
+    int use_nnue;                       // Network loaded when the search started
+    NNUEAccumulator accumulators[MAX_PLY + 1];  // Network accumulators per ply
+} SearchThread;
+
+// State shared by all threads of one search
+struct Searcher {
+    SearchThread* threads;
+    int thread_count;
+    SearchLimits limits;
+    double start;
+    double deadline;                    // 0 when there is no time limit
+    int stop_flag;                      // Raised by the time-keeper, SearcherStop or the main thread
+    int self_timed;                     // No time-keeper thread: the main thread checks the limits
+};
+
+// Searcher behind SearchBestMove/StopSearch/SetSearchThreads
+static Searcher* default_searcher = NULL;
+static int requested_threads = 1;
+
+// Returns a monotonic timestamp in seconds
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Compares two moves for identity
+static int SameMove(const Move* a, const Move* b) {
+    return a->from == b->from && a->to == b->to && a->captured == b->captured;
+}
+
+// Transposition table move: the 16-bit move code in the low half and a second,
+// independent hash of the captured set in the high half, so capture sequences
+// whose 6-bit code tags collide are still told apart
+static unsigned int HashMoveCode(const Move* move) {
+    unsigned int check = (unsigned int)((move->captured * 0xC2B2AE3D27D4EB4FULL) >> 48);
+    return EncodeMove(move) | (check << 16);
+}
+
+// Finds the generated move a table move was stored for; NULL when none
+// matches, or when several still do and the table cannot say which
+static const Move* FindHashMove(const MoveList* list, unsigned int code) {
+    if (code == NO_MOVE) return NULL;
+    const Move* found = NULL;
+    for (int i = 0; i < list->count; i++) {
+        if (HashMoveCode(&list->moves[i]) != code) continue;
+        if (found != NULL) return NULL;
+        found = &list->moves[i];
+    }
+    return found;
+}
+
+// Converts a win/loss score to be relative to the current node before storing
+static int ScoreToTT(int score, int ply) {
+    if (score >= WIN_BOUND) return score + ply;
+    if (score <= -WIN_BOUND) return score - ply;
+    return score;
+}
+
+// Converts a stored win/loss score back to be relative to the root
+static int ScoreFromTT(int score, int ply) {
+    if (score >= WIN_BOUND) return score - ply;
+    if (score <= -WIN_BOUND) return score + ply;
+    return score;
+}
+
+// Sums the node counts published by all threads
+static unsigned long long TotalNodes(const Searcher* searcher) {
+    unsigned long long total = 0;
+    for (int i = 0; i < searcher->thread_count; i++) {
+        total += __atomic_load_n(&searcher->threads[i].published_nodes, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+// Raises the stop flag once the time or node budget is spent
+static void EnforceLimits(Searcher* searcher) {
+    if (searcher->deadline > 0 && Now() >= searcher->deadline) {
+        SearcherStop(searcher);
+    }
+    if (searcher->limits.max_nodes && TotalNodes(searcher) >= searcher->limits.max_nodes) {
+        SearcherStop(searcher);
+    }
+}
+
+// Polls the shared stop flag every CHECK_INTERVAL nodes
+// The first iteration always completes so there is a move to play
+static void CheckLimits(SearchThread* thread) {
+    if ((thread->nodes & CHECK_INTERVAL) != 0) return;
+    __atomic_store_n(&thread->published_nodes, thread->nodes, __ATOMIC_RELAXED);
+    if (thread->searcher->self_timed && thread->id == 0) EnforceLimits(thread->searcher);
+    if (__atomic_load_n(&thread->searcher->stop_flag, __ATOMIC_RELAXED) && thread->root_depth > 1) {
+        thread->stopped = 1;
+    }
+}
+
+// Raises a searcher's stop flag; its running search unwinds and reports its last full iteration.
+// A stop raised before the search starts is kept, so one call is enough from any thread.
+void SearcherStop(Searcher* searcher) {
+    __atomic_store_n(&searcher->stop_flag, 1, __ATOMIC_RELAXED);
+}
+
+// Lowers a stop raised after the searcher's last search had already ended, so the
+// next search is not cut short; call it once the stopped search has been waited for
+void SearcherClearStop(Searcher* searcher) {
+    __atomic_store_n(&searcher->stop_flag, 0, __ATOMIC_RELAXED);
+}
+
+// Time-keeper thread: enforces the time and node budgets so searchers never read the clock
+static void* TimeKeeper(void* arg) {
+    Searcher* searcher = arg;
+    struct timespec interval = { 0, TIMEKEEPER_INTERVAL_NS };
+
+    while (!__atomic_load_n(&searcher->stop_flag, __ATOMIC_RELAXED)) {
+        nanosleep(&interval, NULL);
+        EnforceLimits(searcher);
+    }
+    return NULL;
+}
+
+/**
+ * Creates an independent searcher
+ * Searchers share only the transposition table, so several of them can
+ * search different games at the same time (e.g. one per self-play worker).
+ * @param thread_count Threads per search (clamped to 1..MAX_SEARCH_THREADS)
+ * @return New searcher, or NULL if it could not be allocated
+ */
+Searcher* SearcherCreate(int thread_count) {
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > MAX_SEARCH_THREADS) thread_count = MAX_SEARCH_THREADS;
+
+    Searcher* searcher = calloc(1, sizeof(Searcher));
+    if (searcher == NULL) return NULL;
+    searcher->threads = aligned_alloc(64, thread_count * sizeof(SearchThread));
+    if (searcher->threads == NULL) {
+        free(searcher);
+        return NULL;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        searcher->thread_count = i;
+        memset(&searcher->threads[i], 0, sizeof(SearchThread));
+        if (!ArenaInit(&searcher->threads[i].arena, SEARCH_ARENA_SIZE)) {
+            SearcherFree(searcher);
+            return NULL;
+        }
+    }
+    searcher->thread_count = thread_count;
+    return searcher;
+}
+
+// Releases a searcher (it must not be searching)
+void SearcherFree(Searcher* searcher) {
+    if (searcher == NULL) return;
+    for (int i = 0; i < searcher->thread_count; i++) {
+        ArenaFree(&searcher->threads[i].arena);
+    }
+    free(searcher->threads);
+    free(searcher);
+}
+
+// Raises the default searcher's stop flag
+void StopSearch(void) {
+    if (default_searcher != NULL) SearcherStop(default_searcher);
+}
+
+// Lowers the default searcher's stop flag
+void ClearStopSearch(void) {
+    if (default_searcher != NULL) SearcherClearStop(default_searcher);
+}
+
+/**
+ * Sets how many threads the next searches use
+ * Helper threads share only the transposition table (Lazy SMP).
+ * @param count Number of threads (clamped to 1..MAX_SEARCH_THREADS)
+ * @return 1 on success, 0 if the thread state could not be allocated
+ */
+int SetSearchThreads(int count) {
+    Searcher* searcher = SearcherCreate(count);
+    if (searcher == NULL) return 0;
+
+    SearcherFree(default_searcher);
+    default_searcher = searcher;
+    requested_threads = searcher->thread_count;
+    return 1;
+}
+
+// Returns the number of threads searches use
+int GetSearchThreads(void) {
+    return requested_threads;
+}
+
+// Scores moves for ordering: hash/PV move, captures by size, killers, history
+static void ScoreMoves(SearchThread* thread, const MoveList* list, int* scores,
+                       int ply, const Move* hash_move) {
+    for (int i = 0; i < list->count; i++) {
+        const Move* move = &list->moves[i];
+        if (hash_move && SameMove(move, hash_move)) {
+            scores[i] = ORDER_HASH;
+        } else if (move->captured) {
+            scores[i] = ORDER_CAPTURE + CountBits(move->captured) * 100 + CountBits(move->captured_kings);
+        } else if (SameMove(move, &thread->killers[ply][0])) {
+            scores[i] = ORDER_KILLER1;
+        } else if (SameMove(move, &thread->killers[ply][1])) {
+            scores[i] = ORDER_KILLER2;
+        } else {
+            scores[i] = thread->history[move->from][move->to];
+        }
+    }
+}
+
+// Moves the best-scored remaining move to index and returns it
+static const Move* PickMove(MoveList* list, int* scores, int index) {
+    int best = index;
+    for (int i = index + 1; i < list->count; i++) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    if (best != index) {
+        Move move = list->moves[index];
+        list->moves[index] = list->moves[best];
+        list->moves[best] = move;
+        int score = scores[index];
+        scores[index] = scores[best];
+        scores[best] = score;
+    }
+    return &list->moves[index];
+}
+
+// Records a quiet move that caused a beta cutoff
+static void UpdateQuietStats(SearchThread* thread, const Move* move, int ply, int depth) {
+    if (!SameMove(move, &thread->killers[ply][0])) {
+        thread->killers[ply][1] = thread->killers[ply][0];
+        thread->killers[ply][0] = *move;
+    }
+    int* entry = &thread->history[move->from][move->to];
+    *entry += depth * depth;
+    if (*entry > ORDER_KILLER2 / 2) {
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                thread->history[from][to] /= 2;
+            }
+        }
+    }
+}
+
+// Generates the moves at the current node into a list on the arena, trimmed
+// to the moves found; NULL only if the arena is full
+static MoveList* NewMoveList(SearchThread* thread) {
+    MoveList* list = ArenaAlloc(&thread->arena, sizeof(MoveList));
+    if (list == NULL) return NULL;
+    GenerateMoves(&thread->game, list);
+    ArenaShrink(&thread->arena, list, MOVE_LIST_BYTES(list->count));
+    return list;
+}
+
+// Copies the child's principal variation behind move
+static void UpdatePV(SearchThread* thread, int ply, const Move* move) {
+    thread->pv[ply][0] = *move;
+    int child_length = ply + 1 < MAX_PLY ? thread->pv_length[ply + 1] : 0;
+    memcpy(&thread->pv[ply][1], &thread->pv[ply + 1][0], child_length * sizeof(Move));
+    thread->pv_length[ply] = child_length + 1;
+}
+
+// Plays a move below ply, carrying the network accumulators and the repetition keys along
+static void PlayMove(SearchThread* thread, int ply, const Move* move) {
+    if (thread->use_nnue) {
+        NNUEUpdate(&thread->accumulators[ply], &thread->accumulators[ply + 1],
+                   thread->game.current_player, move);
+    }
+    DoMove(&thread->game, move);
+    thread->keys[thread->key_base + ply + 1] = thread->game.hash;
+    int irreversible = move->captured != 0ULL || !(move->flags & MOVE_KING);
+    thread->quiet_plies[ply + 1] = irreversible ? 0 : thread->quiet_plies[ply] + 1;
+}
+
+// Returns 1 if the position at ply is a draw: it occurred before (in the game or
+// the search path) or the quiet-move limit is reached. One repetition is enough
+// inside the search, since repeating it again cannot be better.
+static int IsDraw(const SearchThread* thread, int ply) {
+    int quiet = thread->quiet_plies[ply];
+    if (quiet >= DRAW_QUIET_PLIES) return 1;
+    const unsigned long long* key = &thread->keys[thread->key_base + ply];
+    for (int back = 4; back <= quiet; back += 2) {
+        if (key[-back] == *key) return 1;
+    }
+    return 0;
+}
+
+// Static score of the position at ply: the network if one is loaded, else the hand-written terms
+static int StaticEval(SearchThread* thread, int ply) {
+    STATS_TIMER_START(evaluate);
+    STATS_INC(STAT_EVALUATIONS);
+    int score = thread->use_nnue ? NNUEEvaluate(&thread->accumulators[ply], thread->game.current_player)
+                                 : Evaluate(&thread->game);
+    STATS_TIMER_STOP(evaluate, STAT_CYCLES_EVALUATE);
+    return score;
+}
+
+/**
+ * Resolves pending captures so the static evaluation is only taken in quiet positions
+ * Captures are mandatory, so there is no stand-pat while a jump is on the board.
+ */
+static int Quiesce(SearchThread* thread, int ply, int alpha, int beta) {
+    thread->nodes++;
+    STATS_INC(STAT_QUIESCE_NODES);
+    thread->pv_length[ply] = 0;
+    CheckLimits(thread);
+    if (thread->stopped) return 0;
+
+    size_t mark = ArenaMark(&thread->arena);
+    MoveList* list = NewMoveList(thread);
+    if (list == NULL) return StaticEval(thread, ply);
+    if (list->count == 0 || list->moves[0].captured == 0ULL || ply >= MAX_PLY - 1) {
+        int count = list->count;
+        ArenaRelease(&thread->arena, mark);
+        return count == 0 ? -WIN_SCORE + ply : StaticEval(thread, ply);
+    }
+
+    for (int i = 0; i < list->count; i++) {
+        const Move* move = &list->moves[i];
+        PlayMove(thread, ply, move);
+        int score = -Quiesce(thread, ply + 1, -beta, -alpha);
+        UndoMove(&thread->game, move);
+        if (thread->stopped) break;
+
+        if (score > alpha) {
+            alpha = score;
+            UpdatePV(thread, ply, move);
+            if (alpha >= beta) break;
+        }
+    }
+    ArenaRelease(&thread->arena, mark);
+    return thread->stopped ? 0 : alpha;
+}
+
+// Negamax alpha-beta over the remaining depth
+static int AlphaBeta(SearchThread* thread, int depth, int ply, int alpha, int beta) {
+    if (depth <= 0 || ply >= MAX_PLY - 1) {
+        return Quiesce(thread, ply, alpha, beta);
+    }
+
+    thread->nodes++;
+    STATS_INC(STAT_NODES);
+    thread->pv_length[ply] = 0;
+    CheckLimits(thread);
+    if (thread->stopped) return 0;
+    if (IsDraw(thread, ply)) return 0;
+
+    // Transposition table cutoff, or at least a move to try first
+    unsigned long long key = thread->game.hash;
+    unsigned int hash_code = NO_MOVE;
+    TTData entry;
+    STATS_INC(STAT_TT_PROBES);
+    if (TTProbe(key, &entry)) {
+        STATS_INC(STAT_TT_HITS);
+        hash_code = entry.move;
+        if (entry.depth >= depth) {
+            int tt_score = ScoreFromTT(entry.score, ply);
+            if (entry.bound == TT_EXACT ||
+                (entry.bound == TT_LOWER && tt_score >= beta) ||
+                (entry.bound == TT_UPPER && tt_score <= alpha)) {
+                STATS_INC(STAT_TT_CUTOFFS);
+                return tt_score;
+            }
+        }
+    }
+
+    // Endgame databases give the exact result; wins are scored like mates at the known distance,
+    // kept above WIN_BOUND so a long database win is never mistaken for an evaluation
+    if (ply > 0 && TBMaxPieces() > 0) {
+        int result, distance;
+        if (TBProbe(&thread->game, &result, &distance)) {
+            STATS_INC(STAT_TB_HITS);
+            int win = WIN_SCORE - ply - distance > WIN_BOUND ? WIN_SCORE - ply - distance : WIN_BOUND + 1;
+            if (result == TB_WIN) return win;
+            if (result == TB_LOSS) return -win;
+            return 0;
+        }
+    }
+
+    size_t mark = ArenaMark(&thread->arena);
+    MoveList* list = NewMoveList(thread);
+    int* scores = list != NULL ? ArenaAlloc(&thread->arena, list->count * sizeof(int)) : NULL;
+    if (scores == NULL) {
+        ArenaRelease(&thread->arena, mark);
+        return Quiesce(thread, ply, alpha, beta);
+    }
+    if (list->count == 0) {
+        ArenaRelease(&thread->arena, mark);
+        return -WIN_SCORE + ply;
+    }
+    STATS_BRANCHING(list->count);
+
+    // A single forced reply does not use up depth
+    if (list->count == 1) depth++;
+
+    ScoreMoves(thread, list, scores, ply, FindHashMove(list, hash_code));
+
+    int original_alpha = alpha;
+    int best_score = -WIN_SCORE;
+    unsigned int best_code = NO_MOVE;
+    for (int i = 0; i < list->count; i++) {
+        const Move* move = PickMove(list, scores, i);
+
+        PlayMove(thread, ply, move);
+        int score = -AlphaBeta(thread, depth - 1, ply + 1, -beta, -alpha);
+        UndoMove(&thread->game, move);
+        if (thread->stopped) break;
+
+        if (score > best_score) {
+            best_score = score;
+            best_code = HashMoveCode(move);
+            if (score > alpha) {
+                alpha = score;
+                UpdatePV(thread, ply, move);
+                if (alpha >= beta) {
+                    STATS_INC(STAT_BETA_CUTOFFS);
+                    STATS_ADD(STAT_FIRST_MOVE_CUTOFFS, i == 0);
+                    if (!move->captured) UpdateQuietStats(thread, move, ply, depth);
+                    break;
+                }
+            }
+        }
+    }
+
+    ArenaRelease(&thread->arena, mark);
+    if (thread->stopped) return 0;
+
+    int bound = best_score >= beta ? TT_LOWER : (best_score > original_alpha ? TT_EXACT : TT_UPPER);
+    TTStore(key, depth, ScoreToTT(best_score, ply), bound, best_code);
+    return best_score;
+}
+
+// Searches every root move at one depth, principal variation move first
+static int SearchRoot(SearchThread* thread, MoveList* root, int depth, int alpha, int beta) {
+    size_t mark = ArenaMark(&thread->arena);
+    int* scores = ArenaAlloc(&thread->arena, root->count * sizeof(int));
+    if (scores == NULL) {
+        // Abandon the iteration: the last completed one (or the first root move) is played
+        thread->stopped = 1;
+        return -WIN_SCORE;
+    }
+    const Move* pv_move = thread->pv_length[0] > 0 ? &thread->pv[0][0] : NULL;
+    ScoreMoves(thread, root, scores, 0, pv_move);
+    thread->nodes++;
+    STATS_INC(STAT_NODES);
+
+    int best_score = -WIN_SCORE;
+    for (int i = 0; i < root->count; i++) {
+        const Move* move = PickMove(root, scores, i);
+
+        PlayMove(thread, 0, move);
+        int score = -AlphaBeta(thread, depth - 1, 1, -beta, -alpha);
+        UndoMove(&thread->game, move);
+        if (thread->stopped) break;
+
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                alpha = score;
+                UpdatePV(thread, 0, move);
+                if (alpha >= beta) break;
+            }
+        }
+    }
+    ArenaRelease(&thread->arena, mark);
+    return best_score;
+}
+
+// Copies the main thread's finished iteration into the result
+static void RecordIteration(const SearchThread* thread, SearchResult* result) {
+    result->best_move = thread->pv[0][0];
+    result->score = thread->score;
+    result->depth = thread->completed_depth;
+    result->pv_length = thread->pv_length[0];
+    memcpy(result->pv, thread->pv[0], thread->pv_length[0] * sizeof(Move));
+}
+
+/**
+ * Iterative deepening loop run by every thread
+ * Helpers start at staggered depths so they fill the table with entries the
+ * main thread will want next; only the main thread checks the soft time
+ * limit and decides when the search is over.
+ */
+static void IterativeDeepening(SearchThread* thread, SearchResult* result) {
+    const Searcher* searcher = thread->searcher;
+    int max_depth = searcher->limits.max_depth > 0 && searcher->limits.max_depth < MAX_PLY
+                    ? searcher->limits.max_depth : MAX_PLY - 1;
+    int score = 0;
+
+    for (int depth = 1 + (thread->id & 1); depth <= max_depth; depth++) {
+        thread->root_depth = depth;
+        int window = ASPIRATION_WINDOW;
+        int alpha = depth >= 3 ? score - window : -WIN_SCORE;
+        int beta = depth >= 3 ? score + window : WIN_SCORE;
+
+        // Re-search with a wider window until the score lands inside it
+        for (;;) {
+            ArenaRelease(&thread->arena, thread->iteration_mark);
+            score = SearchRoot(thread, &thread->root, depth, alpha, beta);
+            if (thread->stopped) break;
+            if (score <= alpha) {
+                alpha = alpha - window < -WIN_SCORE ? -WIN_SCORE : alpha - window;
+            } else if (score >= beta) {
+                beta = beta + window > WIN_SCORE ? WIN_SCORE : beta + window;
+            } else {
+                break;
+            }
+            window *= 2;
+        }
+        if (thread->stopped) break;
+        if (thread->id != 0) continue;
+
+        thread->score = score;
+        thread->completed_depth = depth;
+        RecordIteration(thread, result);
+        if (searcher->limits.report != NULL) {
+            SearchResult progress = *result;
+            progress.nodes = TotalNodes(searcher) - thread->published_nodes + thread->nodes;
+            progress.elapsed = Now() - searcher->start;
+            searcher->limits.report(&progress, searcher->limits.report_context);
+        }
+
+        // A forced win or loss will not change with more depth
+        if (score >= WIN_BOUND || score <= -WIN_BOUND) break;
+        // Do not start an iteration that is unlikely to finish in time
+        if (searcher->deadline > 0 && Now() - searcher->start > (searcher->deadline - searcher->start) / 2) break;
+        if (thread->root.count == 1) break;
+    }
+}
+
+// Entry point of a helper thread
+static void* HelperThread(void* arg) {
+    STATS_TIMER_START(search);
+    IterativeDeepening((SearchThread*)arg, NULL);
+    STATS_TIMER_STOP(search, STAT_CYCLES_SEARCH);
+    return NULL;
+}
+
+// Prepares one thread's private state for a new search
+// Killers and history carry over from the previous search (e.g. a ponder
+// search of the same position); history is halved so recent cutoffs count more
+static void ResetThread(SearchThread* thread, Searcher* searcher, int id,
+                        const GameState* game, const MoveList* root) {
+    thread->root_depth = 0;
+    thread->nodes = 0;
+    thread->published_nodes = 0;
+    thread->stopped = 0;
+    thread->completed_depth = 0;
+    thread->score = 0;
+    for (int from = 0; from < 64; from++) {
+        for (int to = 0; to < 64; to++) {
+            thread->history[from][to] /= 2;
+        }
+    }
+
+    thread->arena.used = 0;
+    thread->arena.peak = 0;
+    memset(thread->pv_length, 0, sizeof(thread->pv_length));
+    for (int ply = 0; ply < MAX_PLY; ply++) {
+        thread->pv[ply] = ArenaAlloc(&thread->arena, (MAX_PLY - ply) * sizeof(Move));
+    }
+    thread->iteration_mark = ArenaMark(&thread->arena);
+    thread->searcher = searcher;
+    thread->id = id;
+    thread->game = *game;
+    thread->root = *root;
+    thread->use_nnue = NNUEEnabled();
+    if (thread->use_nnue) NNUERefresh(game, &thread->accumulators[0]);
+
+    // The game's quiet stretch, if the history ends at this position
+    thread->key_base = 0;
+    thread->quiet_plies[0] = 0;
+    const GameHistory* history = searcher->limits.history;
+    if (history != NULL && HistoryKey(history, history->ply) == game->hash) {
+        int quiet = HistoryQuietPlies(history);
+        thread->key_base = quiet < DRAW_QUIET_PLIES ? quiet : DRAW_QUIET_PLIES;
+        for (int i = 0; i < thread->key_base; i++) {
+            thread->keys[i] = HistoryKey(history, history->ply - thread->key_base + i);
+        }
+        thread->quiet_plies[0] = quiet;
+    }
+    thread->keys[thread->key_base] = game->hash;
+}
+
+/**
+ * Finds the best move by iterative deepening with aspiration windows
+ * All of the searcher's threads search the same root and cooperate
+ * through the transposition table. The table is not aged here, since
+ * several searchers may share it: its owner calls TTNewSearch.
+ * @param searcher Searcher to run (one search at a time per searcher); a stop
+ *                 raised before the call ends the search after its first iteration
+ * @param game Position to search (not modified)
+ * @param limits Depth, time and node limits; use_book lets the opening book answer instead
+ * @param result Output: best move, score, principal variation and statistics
+ * @return 1 if a move was found, 0 if the side to move has no legal moves
+ */
+int SearcherBestMove(Searcher* searcher, const GameState* game, const SearchLimits* limits,
+                     SearchResult* result) {
+    memset(result, 0, sizeof(*result));
+
+    MoveList root;
+    GenerateMoves(game, &root);
+    if (root.count == 0) {
+        result->score = -WIN_SCORE;
+        return 0;
+    }
+    result->best_move = root.moves[0];
+    result->has_move = 1;
+
+    const Move* book_move = limits->use_book ? BookSelectMove(game, &root) : NULL;
+    if (book_move != NULL) {
+        result->best_move = *book_move;
+        result->from_book = 1;
+        result->pv[0] = *book_move;
+        result->pv_length = 1;
+        return 1;
+    }
+
+    searcher->limits = *limits;
+    searcher->start = Now();
+    searcher->deadline = limits->time_ms > 0 ? searcher->start + limits->time_ms / 1000.0 : 0;
+
+    // Without a time-keeper thread the main thread checks the limits itself
+    pthread_t timekeeper;
+    int timed = limits->time_ms > 0 || limits->max_nodes > 0;
+    if (timed) timed = pthread_create(&timekeeper, NULL, TimeKeeper, searcher) == 0;
+    searcher->self_timed = !timed && (limits->time_ms > 0 || limits->max_nodes > 0);
+
+    // Helpers that cannot be started are left out; at worst the main thread searches alone
+    pthread_t helpers[MAX_SEARCH_THREADS];
+    SearchThread* threads = searcher->threads;
+    for (int i = 0; i < searcher->thread_count; i++) {
+        ResetThread(&threads[i], searcher, i, game, &root);
+    }
+    int helper_count = 1;
+    while (helper_count < searcher->thread_count &&
+           pthread_create(&helpers[helper_count], NULL, HelperThread, &threads[helper_count]) == 0) {
+        helper_count++;
+    }
+
+    SearchThread* main_thread = &threads[0];
+    STATS_TIMER_START(search);
+    IterativeDeepening(main_thread, result);
+    STATS_TIMER_STOP(search, STAT_CYCLES_SEARCH);
+    if (main_thread->completed_depth == 0 && main_thread->pv_length[0] > 0) {
+        // Keep a partial first iteration's choice rather than an unsearched move
+        result->best_move = main_thread->pv[0][0];
+    }
+
+    SearcherStop(searcher);
+    for (int i = 1; i < helper_count; i++) {
+        pthread_join(helpers[i], NULL);
+    }
+    if (timed) pthread_join(timekeeper, NULL);
+    SearcherClearStop(searcher);
+
+    result->arena_size = SEARCH_ARENA_SIZE;
+    for (int i = 0; i < searcher->thread_count; i++) {
+        result->nodes += threads[i].nodes;
+        if (threads[i].arena.peak > result->arena_peak) result->arena_peak = threads[i].arena.peak;
+    }
+    result->elapsed = Now() - searcher->start;
+    return 1;
+}
+
+/**
+ * Finds the best move with the default searcher
+ * Uses the number of threads set by SetSearchThreads, and starts a new
+ * transposition table generation.
+ * @return 1 if a move was found, 0 if the side to move has no legal moves
+ */
+int SearchBestMove(const GameState* game, const SearchLimits* limits, SearchResult* result) {
+    if (default_searcher == NULL && !SetSearchThreads(requested_threads)) return 0;
+    TTNewSearch();
+    return SearcherBestMove(default_searcher, game, limits, result);
+}
@@ -0,0 +1,67 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+#include "board.h"
+#include "history.h"
+#include "movegen.h"
+
+// Deepest ply the search can reach (including capture sequences)
+#define MAX_PLY 128
+
+// Most threads a single search can use
+#define MAX_SEARCH_THREADS 256
+
+// Score for a side that has no legal moves left (adjusted by ply)
+#define WIN_SCORE 30000
+#define WIN_BOUND (WIN_SCORE - MAX_PLY)
+
+// Outcome of a search
+typedef struct {
+    Move best_move;                 // Valid only if has_move is set
+    int has_move;                   // 0 when the side to move has no legal moves
+    int from_book;                  // Move came from the opening book (nothing was searched)
+    int score;                      // From the side to move's point of view
+    int depth;                      // Last fully completed iteration
+    unsigned long long nodes;       // Nodes visited
+    double elapsed;                 // Seconds spent
+    size_t arena_peak;              // Most search stack arena bytes any thread used
+    size_t arena_size;              // Arena capacity per thread
+    Move pv[MAX_PLY];               // Principal variation
+    int pv_length;
+} SearchResult;
+
+// Limits for one search; zero means "no limit"
+typedef struct {
+    int max_depth;                  // Iterative deepening stops after this depth
+    int time_ms;                    // Hard time budget for the whole search
+    unsigned long long max_nodes;   // Node budget
+    int use_book;                   // Play the opening book's move without searching
+    // Called by the searching thread after every completed iteration (may be NULL)
+    void (*report)(const SearchResult* result, void* context);
+    void* report_context;
+    // Game leading to the searched position, so repetitions count as draws (may be NULL)
+    const GameHistory* history;
+} SearchLimits;
+
+// Independent search instance (threads, limits, stop flag); all share the TT
+typedef struct Searcher Searcher;
+
+// Searching with the default searcher
+int SearchBestMove(const GameState* game, const SearchLimits* limits, SearchResult* result);
+void StopSearch(void);
+void ClearStopSearch(void);
+
+// Searching with private searchers, e.g. one per concurrent game
+Searcher* SearcherCreate(int thread_count);
+void SearcherFree(Searcher* searcher);
+int SearcherBestMove(Searcher* searcher, const GameState* game, const SearchLimits* limits,
+                     SearchResult* result);
+void SearcherStop(Searcher* searcher);
+void SearcherClearStop(Searcher* searcher);
+
+// Thread configuration
+int SetSearchThreads(int count);
+int GetSearchThreads(void);
+
+#endif // SEARCH_H
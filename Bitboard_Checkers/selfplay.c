@@ -0,0 +1,462 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "archive.h"
+#include "bitops.h"
+#include "board.h"
+#include "game.h"
+#include "history.h"
+#include "movegen.h"
+#include "render.h"
+#include "search.h"
+#include "stats.h"
+#include "tt.h"
+#include "zobrist.h"
+
+// Games a worker collects before writing them out together
+#define DEFAULT_BATCH 256
+
+// Games still running after this many plies are adjudicated as draws
+#define DEFAULT_MAX_PLIES 300
+
+// Statistics resolution: game lengths and piece counts per this many plies
+#define LENGTH_BUCKET 10
+#define MAX_BUCKETS (RECORD_MAX_PLIES / LENGTH_BUCKET + 1)
+
+// Settings shared by every worker
+typedef struct {
+    unsigned long long games;
+    int threads;
+    int engine;                         // 0 = random moves, 1 = engine moves
+    int depth;                          // Engine search depth
+    int random_plies;                   // Random opening plies before the engine takes over
+    int max_plies;
+    int batch;
+    int verify;                         // Cross-check hashing and game-over detection every ply
+    unsigned long long seed;
+    const char* output;                 // Archive to write, or NULL
+    const char* openings;               // Archive whose final positions start the games, or NULL
+    int watch_ms;                       // Spectator grid refresh interval (0 = progress line only)
+} Settings;
+
+// Aggregate results; each worker fills its own and they are summed at the end
+typedef struct {
+    unsigned long long games;
+    unsigned long long results[4];      // Indexed by GameResult
+    unsigned long long plies;
+    unsigned long long captures;
+    unsigned long long promotions;
+    unsigned long long rule_draws;      // Draws by repetition or the quiet-move rule
+    unsigned long long errors;          // Rule inconsistencies found with --verify
+    unsigned long long length_histogram[MAX_BUCKETS];
+    unsigned long long trajectory_games[MAX_BUCKETS];  // Games still running at each bucket start
+    unsigned long long trajectory_red[MAX_BUCKETS];    // Red pieces summed over those games
+    unsigned long long trajectory_black[MAX_BUCKETS];
+} Stats;
+
+static Settings settings;
+static Stats* worker_stats;
+static LiveGame* live = NULL;           // One per worker with --watch
+static GameState* openings = NULL;
+static int opening_count = 0;
+static ArchiveWriter writer;
+static int write_failed = 0;
+static unsigned long long next_game = 0;
+static unsigned long long games_done = 0;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// SplitMix64; every game is seeded from its number, so results do not depend on scheduling
+static unsigned long long NextRandom(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Publishes a worker's position to the spectator grid; result is NULL while the game goes on
+static void ShowGame(LiveGame* view, unsigned long long number, const GameState* game, int ply,
+                     const char* result) {
+    char title[64];
+    snprintf(title, sizeof(title), "Game %llu", number + 1);
+    LiveGameShow(view, title, game, ply, result);
+}
+
+// Checks the incremental state against from-scratch computations; returns the number of mismatches
+static int VerifyPosition(const GameState* game, int move_count) {
+    int errors = 0;
+    if (game->hash != ComputeHash(game)) errors++;
+
+    // CheckWinCondition looks at the player who just moved and asks whether the next one can move
+    GameState previous = *game;
+    previous.current_player ^= 1;
+    if ((CheckWinCondition(&previous, NULL) != RESULT_NONE) != (move_count == 0)) errors++;
+    return errors;
+}
+
+/**
+ * Plays one game to the end
+ * @param number Game number (selects the opening and seeds the random moves)
+ * @param searcher Worker's private searcher (engine mode only)
+ * @param record Output: the game
+ * @param history Worker's scratch history (draw rules and the engine's repetition checks)
+ * @param stats Statistics to add the game to
+ * @param view Where the game is shown with --watch, or NULL
+ */
+static void PlayGame(unsigned long long number, Searcher* searcher, GameRecord* record, GameHistory* history,
+                     Stats* stats, LiveGame* view) {
+    unsigned long long rng = settings.seed ^ (number * 0xD1B54A32D192ED03ULL);
+    GameState game;
+    if (opening_count > 0) {
+        game = openings[number % opening_count];
+    } else {
+        InitializeGame(&game);
+    }
+    RecordStart(record, &game);
+    HistoryStart(history, &game);
+
+    SearchLimits limits = { settings.depth, 0, 0, 0, NULL, NULL, history };
+    SearchResult result;
+    MoveList list;
+    int ply = 0;
+    for (;;) {
+        if (view != NULL) ShowGame(view, number, &game, ply, NULL);
+        GenerateMoves(&game, &list);
+        if (settings.verify) stats->errors += VerifyPosition(&game, list.count);
+
+        if (ply % LENGTH_BUCKET == 0) {
+            int bucket = ply / LENGTH_BUCKET;
+            stats->trajectory_games[bucket]++;
+            stats->trajectory_red[bucket] += CountBits(game.red_pieces | game.red_kings);
+            stats->trajectory_black[bucket] += CountBits(game.black_pieces | game.black_kings);
+        }
+
+        if (list.count == 0) {
+            record->result = game.current_player == 0 ? RESULT_BLACK_WINS : RESULT_RED_WINS;
+            break;
+        }
+        if (ply >= settings.max_plies) {
+            record->result = RESULT_DRAW;
+            break;
+        }
+        if (HistoryIsDraw(history)) {
+            record->result = RESULT_DRAW;
+            stats->rule_draws++;
+            break;
+        }
+
+        const Move* move = &list.moves[NextRandom(&rng) % list.count];
+        if (settings.engine && ply >= settings.random_plies && list.count > 1 &&
+            SearcherBestMove(searcher, &game, &limits, &result)) {
+            move = &result.best_move;
+        }
+
+        if (move->captured) stats->captures++;
+        if (move->flags & MOVE_PROMOTION) stats->promotions++;
+        RecordAddMove(record, move);
+        HistoryAddMove(history, move);
+        game = history->position;
+        ply++;
+    }
+
+    if (view != NULL) {
+        static const char* results[] = { "", "red won", "black won", "draw" };
+        ShowGame(view, number, &game, ply, results[record->result]);
+    }
+    stats->games++;
+    stats->results[record->result]++;
+    stats->plies += ply;
+    stats->length_histogram[ply / LENGTH_BUCKET]++;
+}
+
+// Writes a worker's finished batch; games are never all held in memory
+static void FlushBatch(GameRecord* batch, int count) {
+    if (settings.output == NULL || count == 0) return;
+    if (ArchiveAppendBatch(&writer, batch, count, NULL) != FILE_OK) {
+        __atomic_store_n(&write_failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Worker: claims game numbers until all games are played
+static void* Worker(void* arg) {
+    int index = (int)(size_t)arg;
+    Stats* stats = &worker_stats[index];
+    LiveGame* view = live != NULL ? &live[index] : NULL;
+    Searcher* searcher = settings.engine ? SearcherCreate(1) : NULL;
+    GameRecord* batch = malloc(settings.batch * sizeof(GameRecord));
+    GameHistory* history = malloc(sizeof(GameHistory));
+    if (batch == NULL || history == NULL || (settings.engine && searcher == NULL)) {
+        printf("Error: Could not allocate worker state!\n");
+        exit(1);
+    }
+
+    int pending = 0;
+    for (;;) {
+        unsigned long long number = __atomic_fetch_add(&next_game, 1, __ATOMIC_RELAXED);
+        if (number >= settings.games) break;
+
+        PlayGame(number, searcher, &batch[pending++], history, stats, view);
+        __atomic_fetch_add(&games_done, 1, __ATOMIC_RELAXED);
+        if (pending == settings.batch) {
+            FlushBatch(batch, pending);
+            pending = 0;
+        }
+    }
+    FlushBatch(batch, pending);
+
+    free(batch);
+    free(history);
+    SearcherFree(searcher);
+    return NULL;
+}
+
+// Loads the final position of every game in an archive as an opening
+static int LoadOpenings(const char* path) {
+    Archive archive;
+    if (ArchiveOpen(&archive, path) != FILE_OK || archive.count == 0) return 0;
+
+    openings = malloc(archive.count * sizeof(GameState));
+    GameRecord* record = malloc(sizeof(GameRecord));
+    if (openings == NULL || record == NULL) {
+        ArchiveClose(&archive);
+        return 0;
+    }
+    for (unsigned long long i = 0; i < archive.count; i++) {
+        if (!ArchiveGetGame(&archive, i, record)) continue;
+        RecordReplay(record, record->ply_count, &openings[opening_count]);
+        openings[opening_count++].game_over = 0;
+    }
+    free(record);
+    ArchiveClose(&archive);
+    return opening_count;
+}
+
+// Adds one worker's statistics into the total
+static void MergeStats(Stats* total, const Stats* part) {
+    unsigned long long* to = (unsigned long long*)total;
+    const unsigned long long* from = (const unsigned long long*)part;
+    for (size_t i = 0; i < sizeof(Stats) / sizeof(unsigned long long); i++) {
+        to[i] += from[i];
+    }
+}
+
+// Prints the aggregate report
+static void PrintReport(const Stats* stats, double elapsed) {
+    double games = stats->games > 0 ? (double)stats->games : 1.0;
+
+    printf("\nGames:        %llu in %.2fs (%.1f games/sec, %.0f plies/sec)\n", stats->games, elapsed,
+           stats->games / elapsed, stats->plies / elapsed);
+    printf("Red wins:     %llu (%.1f%%)\n", stats->results[RESULT_RED_WINS],
+           100.0 * stats->results[RESULT_RED_WINS] / games);
+    printf("Black wins:   %llu (%.1f%%)\n", stats->results[RESULT_BLACK_WINS],
+           100.0 * stats->results[RESULT_BLACK_WINS] / games);
+    printf("Draws:        %llu (%.1f%%, move limit %d plies)\n", stats->results[RESULT_DRAW],
+           100.0 * stats->results[RESULT_DRAW] / games, settings.max_plies);
+    printf("  by rule:    %llu (threefold repetition or %d moves without capture or man move)\n",
+           stats->rule_draws, DRAW_QUIET_PLIES / 2);
+    printf("Avg length:   %.1f plies\n", stats->plies / games);
+    printf("Captures:     %.2f per game\n", stats->captures / games);
+    printf("Promotions:   %.2f per game\n", stats->promotions / games);
+    if (settings.verify) {
+        printf("Rule errors:  %llu\n", stats->errors);
+    }
+
+    unsigned long long peak = 1;
+    for (int i = 0; i < MAX_BUCKETS; i++) {
+        if (stats->length_histogram[i] > peak) peak = stats->length_histogram[i];
+    }
+
+    printf("\n Plies      Games  Share   Avg red  Avg black  Length distribution\n");
+    for (int i = 0; i < MAX_BUCKETS; i++) {
+        if (stats->trajectory_games[i] == 0 && stats->length_histogram[i] == 0) continue;
+        double running = stats->trajectory_games[i] > 0 ? (double)stats->trajectory_games[i] : 1.0;
+        int bar = (int)(40 * stats->length_histogram[i] / peak);
+        printf("%3d-%-3d %9llu %5.1f%% %9.2f %10.2f  ", i * LENGTH_BUCKET, i * LENGTH_BUCKET + LENGTH_BUCKET - 1,
+               stats->length_histogram[i], 100.0 * stats->length_histogram[i] / games,
+               stats->trajectory_red[i] / running, stats->trajectory_black[i] / running);
+        for (int j = 0; j < bar; j++) putchar('#');
+        putchar('\n');
+    }
+}
+
+// Spectator footer: overall progress; the last frame is drawn once every game is played
+static int ProgressFooter(char* footer, size_t size, void* context) {
+    double start = *(const double*)context;
+    unsigned long long done = __atomic_load_n(&games_done, __ATOMIC_RELAXED);
+    double elapsed = Now() - start;
+    snprintf(footer, size, "%llu/%llu games (%.1f games/sec)", done, settings.games,
+             elapsed > 0 ? done / elapsed : 0.0);
+    return done >= settings.games;
+}
+
+static void PrintUsage(const char* program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --games N         Games to play (default 1000)\n");
+    printf("  --threads N       Worker threads (default: all cores)\n");
+    printf("  --engine DEPTH    Engine moves searched to DEPTH (default: random moves)\n");
+    printf("  --random N        Random opening plies before the engine plays (default 4)\n");
+    printf("  --max-plies N     Adjudicate a draw after N plies (default %d)\n", DEFAULT_MAX_PLIES);
+    printf("  --openings FILE   Start from the final positions of an archive's games\n");
+    printf("  --output FILE     Append every game to an archive\n");
+    printf("  --batch N         Games per worker between archive writes (default %d)\n", DEFAULT_BATCH);
+    printf("  --hash MB         Transposition table size for engine games (default %d)\n", TT_DEFAULT_MB);
+    printf("  --seed N          Random seed (default 1)\n");
+    printf("  --verify          Cross-check hashing and game-over detection every ply\n");
+    printf("  --watch MS        Show the running games in a grid redrawn every MS milliseconds\n");
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    settings.games = 1000;
+    settings.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    settings.random_plies = 4;
+    settings.max_plies = DEFAULT_MAX_PLIES;
+    settings.batch = DEFAULT_BATCH;
+    settings.seed = 1;
+    int hash_mb = TT_DEFAULT_MB;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && has_value) {
+            settings.games = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            settings.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--engine") == 0 && has_value) {
+            settings.engine = 1;
+            settings.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--random") == 0 && has_value) {
+            settings.random_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-plies") == 0 && has_value) {
+            settings.max_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--openings") == 0 && has_value) {
+            settings.openings = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            settings.output = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && has_value) {
+            settings.batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hash") == 0 && has_value) {
+            hash_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            settings.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            settings.verify = 1;
+        } else if (strcmp(argv[i], "--watch") == 0 && has_value) {
+            settings.watch_ms = atoi(argv[++i]);
+            if (settings.watch_ms <= 0) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (settings.games == 0 || settings.threads <= 0 || settings.batch <= 0 || hash_mb <= 0 ||
+        settings.max_plies <= 0 || settings.max_plies >= RECORD_MAX_PLIES ||
+        (settings.engine && settings.depth <= 0)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (settings.engine && !TTInit(hash_mb)) {
+        printf("Error: Could not allocate %d MB for the hash table!\n", hash_mb);
+        return 1;
+    }
+    if (settings.openings != NULL && !LoadOpenings(settings.openings)) {
+        printf("Error: Could not read openings from '%s'!\n", settings.openings);
+        return 1;
+    }
+    if (settings.output != NULL && ArchiveWriterOpen(&writer, settings.output) != FILE_OK) {
+        printf("Error: Could not open '%s' for writing!\n", settings.output);
+        return 1;
+    }
+
+    printf("Self-play: %llu games, %d threads, %s", settings.games, settings.threads,
+           settings.engine ? "engine" : "random moves");
+    if (settings.engine) printf(" (depth %d after %d random plies)", settings.depth, settings.random_plies);
+    if (opening_count > 0) printf(", %d openings", opening_count);
+    printf("\n");
+
+    Stats* stats = calloc(settings.threads, sizeof(Stats));
+    pthread_t* workers = malloc(settings.threads * sizeof(pthread_t));
+    // The grid needs a terminal; redirected output gets the plain progress line
+    if (settings.watch_ms > 0 && !isatty(STDOUT_FILENO)) settings.watch_ms = 0;
+    int live_count = settings.threads;
+    if (settings.watch_ms > 0) live = LiveGamesCreate(live_count);
+    if (stats == NULL || workers == NULL || (settings.watch_ms > 0 && live == NULL)) {
+        printf("Error: Could not allocate worker state!\n");
+        return 1;
+    }
+
+    worker_stats = stats;
+    double start = Now();
+    // Workers take games from a shared counter, so fewer of them still play every game
+    int started = 0;
+    while (started < settings.threads &&
+           pthread_create(&workers[started], NULL, Worker, (void*)(size_t)started) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        printf("Error: Could not start any worker thread!\n");
+        return 1;
+    }
+    if (started < settings.threads) {
+        printf("Warning: Only %d of %d worker threads could be started\n", started, settings.threads);
+        settings.threads = started;
+    }
+
+    if (live != NULL) {
+        if (!Spectate(live, settings.threads, settings.watch_ms, ProgressFooter, &start)) {
+            printf("Error: Could not allocate the spectator grid!\n");
+            return 1;
+        }
+    } else {
+        // Progress line while the workers run
+        struct timespec interval = { 0, 500000000 };
+        unsigned long long done;
+        while ((done = __atomic_load_n(&games_done, __ATOMIC_RELAXED)) < settings.games) {
+            nanosleep(&interval, NULL);
+            double elapsed = Now() - start;
+            printf("\r%llu/%llu games (%.1f games/sec)", done, settings.games, elapsed > 0 ? done / elapsed : 0.0);
+            fflush(stdout);
+        }
+    }
+
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < settings.threads; i++) {
+        pthread_join(workers[i], NULL);
+        MergeStats(&total, &stats[i]);
+    }
+    double elapsed = Now() - start;
+    printf("\r%llu/%llu games played%30s\n", total.games, settings.games, "");
+
+    if (settings.output != NULL) {
+        if (ArchiveWriterClose(&writer) != FILE_OK) write_failed = 1;
+        if (write_failed) {
+            printf("Error: Writing '%s' failed!\n", settings.output);
+        } else {
+            printf("Games appended to '%s'\n", settings.output);
+        }
+    }
+
+    PrintReport(&total, elapsed);
+    if (StatsEnabled()) {
+        printf("\n");
+        StatsWriteReport(stdout);
+    }
+    free(stats);
+    free(workers);
+    LiveGamesFree(live, live_count);
+    free(openings);
+    return write_failed;
+}
@@ -0,0 +1,190 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stats.h"
+
+static const char* const COUNTER_NAMES[STAT_COUNT] = {
+    "generate_calls", "moves_generated", "captures_generated", "moves_made", "pieces_captured",
+    "promotions", "nodes", "quiesce_nodes", "tt_probes", "tt_hits", "tt_cutoffs", "tb_hits",
+    "beta_cutoffs", "first_move_cutoffs", "evaluations", "cycles_generate", "cycles_evaluate",
+    "cycles_search",
+};
+
+#ifdef CHECKERS_STATS
+
+// Most threads counting at the same time; slots of finished threads are reused
+#define MAX_STATS_SLOTS 1024
+
+__thread StatsSlot* stats_slot = NULL;
+
+static StatsSlot* slots[MAX_STATS_SLOTS];
+static int slot_in_use[MAX_STATS_SLOTS];
+static int slot_count = 0;
+static StatsSlot retired;               // Counts of threads that have exited
+static StatsSlot overflow;              // Shared fallback once every slot is taken (not thread-safe)
+static pthread_mutex_t slot_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+
+#if !defined(__x86_64__) && !defined(__i386__)
+unsigned long long StatsCycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+static void AddSlot(StatsSlot* total, const StatsSlot* slot) {
+    for (int i = 0; i < STAT_COUNT; i++) total->counters[i] += slot->counters[i];
+    for (int i = 0; i < STATS_BRANCHING_BUCKETS; i++) total->branching[i] += slot->branching[i];
+}
+
+// Thread exit: fold the thread's counts into the retired totals and free its slot
+static void ReleaseSlot(void* arg) {
+    StatsSlot* slot = arg;
+    pthread_mutex_lock(&slot_lock);
+    AddSlot(&retired, slot);
+    memset(slot, 0, sizeof(*slot));
+    for (int i = 0; i < slot_count; i++) {
+        if (slots[i] == slot) slot_in_use[i] = 0;
+    }
+    pthread_mutex_unlock(&slot_lock);
+}
+
+static void CreateSlotKey(void) {
+    pthread_key_create(&slot_key, ReleaseSlot);
+}
+
+// Gives the calling thread a slot on its first count
+StatsSlot* StatsRegisterThread(void) {
+    pthread_once(&slot_key_once, CreateSlotKey);
+    pthread_mutex_lock(&slot_lock);
+    StatsSlot* slot = NULL;
+    for (int i = 0; i < slot_count && slot == NULL; i++) {
+        if (!slot_in_use[i]) {
+            slot_in_use[i] = 1;
+            slot = slots[i];
+        }
+    }
+    if (slot == NULL && slot_count < MAX_STATS_SLOTS) {
+        slot = calloc(1, sizeof(StatsSlot));
+        if (slot != NULL) {
+            slots[slot_count] = slot;
+            slot_in_use[slot_count++] = 1;
+        }
+    }
+    pthread_mutex_unlock(&slot_lock);
+
+    if (slot == NULL) {
+        stats_slot = &overflow;
+        return stats_slot;
+    }
+    pthread_setspecific(slot_key, slot);
+    stats_slot = slot;
+    return slot;
+}
+
+int StatsEnabled(void) {
+    return 1;
+}
+
+/**
+ * Sums every thread's counts
+ * Running threads are read without stopping them, so a report taken during
+ * a search is a close snapshot rather than an exact one.
+ * @param total Output
+ */
+void StatsCollect(StatsSlot* total) {
+    pthread_mutex_lock(&slot_lock);
+    *total = retired;
+    AddSlot(total, &overflow);
+    for (int i = 0; i < slot_count; i++) {
+        if (slot_in_use[i]) AddSlot(total, slots[i]);
+    }
+    pthread_mutex_unlock(&slot_lock);
+}
+
+// Zeroes every count (no thread may be counting)
+void StatsReset(void) {
+    pthread_mutex_lock(&slot_lock);
+    memset(&retired, 0, sizeof(retired));
+    memset(&overflow, 0, sizeof(overflow));
+    for (int i = 0; i < slot_count; i++) memset(slots[i], 0, sizeof(StatsSlot));
+    pthread_mutex_unlock(&slot_lock);
+}
+
+#else
+
+int StatsEnabled(void) {
+    return 0;
+}
+
+void StatsCollect(StatsSlot* total) {
+    memset(total, 0, sizeof(*total));
+}
+
+void StatsReset(void) {
+}
+
+#endif // CHECKERS_STATS
+
+// Ratio as a percentage, 0 when the denominator is 0
+static double Percent(unsigned long long part, unsigned long long whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+/**
+ * Writes the aggregated counters as a readable report
+ * @param file Destination stream
+ */
+void StatsWriteReport(FILE* file) {
+    if (!StatsEnabled()) {
+        fprintf(file, "Statistics are not compiled in (rebuild with make STATS=1)\n");
+        return;
+    }
+
+    StatsSlot total;
+    StatsCollect(&total);
+    const unsigned long long* c = total.counters;
+
+    fprintf(file, "Statistics\n");
+    for (int i = 0; i < STAT_COUNT; i++) {
+        fprintf(file, "  %-20s %16llu\n", COUNTER_NAMES[i], c[i]);
+    }
+
+    unsigned long long all_nodes = c[STAT_NODES] + c[STAT_QUIESCE_NODES];
+    fprintf(file, "\n");
+    fprintf(file, "  Moves per generation     %8.2f\n",
+            c[STAT_GENERATE_CALLS] ? (double)c[STAT_MOVES_GENERATED] / c[STAT_GENERATE_CALLS] : 0.0);
+    if (all_nodes == 0) return;
+    fprintf(file, "  Quiescence nodes         %7.1f%%\n", Percent(c[STAT_QUIESCE_NODES], all_nodes));
+    fprintf(file, "  TT hit rate              %7.1f%%\n", Percent(c[STAT_TT_HITS], c[STAT_TT_PROBES]));
+    fprintf(file, "  TT cutoff rate           %7.1f%%\n", Percent(c[STAT_TT_CUTOFFS], c[STAT_TT_PROBES]));
+    fprintf(file, "  Cutoff on first move     %7.1f%%\n", Percent(c[STAT_FIRST_MOVE_CUTOFFS], c[STAT_BETA_CUTOFFS]));
+    fprintf(file, "  Move generation time     %7.1f%% of search\n",
+            Percent(c[STAT_CYCLES_GENERATE], c[STAT_CYCLES_SEARCH]));
+    fprintf(file, "  Evaluation time          %7.1f%% of search\n",
+            Percent(c[STAT_CYCLES_EVALUATE], c[STAT_CYCLES_SEARCH]));
+    fprintf(file, "  Ticks per node           %8.1f\n",
+            all_nodes ? (double)c[STAT_CYCLES_SEARCH] / all_nodes : 0.0);
+
+    unsigned long long branching_total = 0, branching_moves = 0, largest = 0;
+    for (int i = 0; i < STATS_BRANCHING_BUCKETS; i++) {
+        branching_total += total.branching[i];
+        branching_moves += (unsigned long long)i * total.branching[i];
+        if (total.branching[i] > largest) largest = total.branching[i];
+    }
+    if (branching_total == 0) return;
+
+    fprintf(file, "\n  Legal moves at full-width nodes (average %.2f)\n",
+            (double)branching_moves / branching_total);
+    // Bucket 0 (no legal moves: the side to move has lost) counts in the average, so it is shown too
+    for (int i = 0; i < STATS_BRANCHING_BUCKETS; i++) {
+        int bar = (int)(40 * total.branching[i] / largest);
+        fprintf(file, "  %3d%s %12llu %5.1f%%  ", i, i == STATS_BRANCHING_BUCKETS - 1 ? "+" : " ",
+                total.branching[i], Percent(total.branching[i], branching_total));
+        for (int j = 0; j < bar; j++) fputc('#', file);
+        fputc('\n', file);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+// Hot-path instrumentation. Counters exist only in builds compiled with
+// CHECKERS_STATS (make STATS=1); otherwise every STATS_* macro expands to
+// nothing and the rules and search code are unchanged. Each thread counts
+// into its own slot, so enabled builds add no shared writes either.
+
+typedef enum {
+    STAT_GENERATE_CALLS = 0,
+    STAT_MOVES_GENERATED,
+    STAT_CAPTURES_GENERATED,            // Capture sequences among the generated moves
+    STAT_MOVES_MADE,                    // DoMove, MovePiece and CapturePiece sequences
+    STAT_PIECES_CAPTURED,
+    STAT_PROMOTIONS,
+    STAT_NODES,                         // Full-width search nodes (root included)
+    STAT_QUIESCE_NODES,
+    STAT_TT_PROBES,
+    STAT_TT_HITS,
+    STAT_TT_CUTOFFS,
+    STAT_TB_HITS,
+    STAT_BETA_CUTOFFS,
+    STAT_FIRST_MOVE_CUTOFFS,            // Beta cutoffs by the first move searched
+    STAT_EVALUATIONS,
+    STAT_CYCLES_GENERATE,               // Timers, in CPU timestamp ticks
+    STAT_CYCLES_EVALUATE,
+    STAT_CYCLES_SEARCH,
+    STAT_COUNT
+} StatCounter;
+
+// Branching factor histogram buckets (legal moves at full-width nodes; the last collects the rest)
+#define STATS_BRANCHING_BUCKETS 16
+
+typedef struct {
+    unsigned long long counters[STAT_COUNT];
+    unsigned long long branching[STATS_BRANCHING_BUCKETS];
+} StatsSlot;
+
+// Aggregation (available in every build; all zero without CHECKERS_STATS)
+int StatsEnabled(void);
+void StatsCollect(StatsSlot* total);
+void StatsReset(void);
+void StatsWriteReport(FILE* file);
+
+#ifdef CHECKERS_STATS
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define StatsCycles() __rdtsc()
+#else
+unsigned long long StatsCycles(void);
+#endif
+
+extern __thread StatsSlot* stats_slot;
+StatsSlot* StatsRegisterThread(void);
+
+static inline StatsSlot* StatsThreadSlot(void) {
+    return stats_slot != NULL ? stats_slot : StatsRegisterThread();
+}
+
+#define STATS_ADD(counter, amount) (StatsThreadSlot()->counters[counter] += (amount))
+#define STATS_INC(counter) STATS_ADD(counter, 1)
+#define STATS_BRANCHING(moves) \
+    (StatsThreadSlot()->branching[(moves) < STATS_BRANCHING_BUCKETS ? (moves) : STATS_BRANCHING_BUCKETS - 1]++)
+#define STATS_TIMER_START(name) unsigned long long stats_timer_##name = StatsCycles()
+#define STATS_TIMER_STOP(name, counter) STATS_ADD(counter, StatsCycles() - stats_timer_##name)
+
+#else
+
+#define STATS_ADD(counter, amount) ((void)0)
+#define STATS_INC(counter) ((void)0)
+#define STATS_BRANCHING(moves) ((void)0)
+#define STATS_TIMER_START(name) ((void)0)
+#define STATS_TIMER_STOP(name, counter) ((void)0)
+
+#endif // CHECKERS_STATS
+
+#endif // STATS_H
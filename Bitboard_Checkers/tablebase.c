@@ -0,0 +1,419 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tablebase.h"
+#include "bitops.h"
+#include "board32.h"
+
+// File layout (little-endian, native struct packing):
+//   TBFileHeader
+//   unsigned long long block_offsets[block_count + 1]   (relative to data start)
+//   data: per block, (run length, value) byte pairs
+#define TB_MAGIC   0x42544B43U      // "CKTB"
+#define TB_VERSION 1
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    int red_men;
+    int red_kings;
+    int black_men;
+    int black_kings;
+    unsigned long long entry_count;
+    unsigned int block_entries;
+    unsigned int block_count;
+} TBFileHeader;
+
+// Slice states in the probe cache
+#define SLICE_UNKNOWN 0
+#define SLICE_MISSING 1
+#define SLICE_MAPPED  2
+
+typedef struct {
+    int state;
+    const unsigned char* map;           // Whole file
+    size_t map_size;
+    const unsigned long long* offsets;  // Block offsets
+    const unsigned char* data;          // Compressed blocks
+    unsigned long long entry_count;
+} TBSlice;
+
+static TBSlice slices[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1];
+static pthread_mutex_t slice_lock = PTHREAD_MUTEX_INITIALIZER;
+static char tb_directory[512];
+static int tb_max_pieces = 0;
+
+// Binomial coefficients C(n, k) for n, k <= 32
+static unsigned long long binomial[33][33];
+static int binomial_ready = 0;
+
+static void InitBinomials(void) {
+    if (binomial_ready) return;
+    for (int n = 0; n <= 32; n++) {
+        binomial[n][0] = 1;
+        for (int k = 1; k <= n; k++) {
+            binomial[n][k] = binomial[n - 1][k - 1] + (k <= n - 1 ? binomial[n - 1][k] : 0);
+        }
+    }
+    binomial_ready = 1;
+}
+
+// Men never stand on their own king row
+#define RED_MAN_SQUARES   (~ROW32(7))
+#define BLACK_MAN_SQUARES (~ROW32(0))
+
+// Counts the pieces of each kind in a compact position
+void TBGetMaterial(const CompactState* position, TBMaterial* material) {
+    material->red_men = CountBits(position->red_men);
+    material->red_kings = CountBits(position->red_kings);
+    material->black_men = CountBits(position->black_men);
+    material->black_kings = CountBits(position->black_kings);
+}
+
+/**
+ * Number of indices in a slice: each piece kind is placed on the squares
+ * the earlier kinds left free, once for each side to move
+ */
+unsigned long long TBSliceSize(const TBMaterial* material) {
+    InitBinomials();
+    int free_squares = 32;
+    unsigned long long size = 2;
+    int counts[4] = { material->red_men, material->red_kings, material->black_men, material->black_kings };
+    for (int i = 0; i < 4; i++) {
+        if (counts[i] > free_squares) return 0;
+        size *= binomial[free_squares][counts[i]];
+        free_squares -= counts[i];
+    }
+    return size;
+}
+
+// Combinatorial rank of a set among the squares not in occupied
+static unsigned long long RankSet(unsigned int set, unsigned int occupied) {
+    unsigned long long compressed = ExtractBits(set, ~occupied & 0xFFFFFFFFULL);
+    unsigned long long rank = 0;
+    int i = 1;
+    int square;
+    FOR_EACH_BIT(square, compressed) {
+        rank += binomial[square][i++];
+    }
+    return rank;
+}
+
+// Inverse of RankSet: the k-square set with the given rank among free squares
+static unsigned int UnrankSet(unsigned long long rank, int k, unsigned int occupied) {
+    unsigned long long compressed = 0;
+    int square = 32;
+    for (int i = k; i >= 1; i--) {
+        do {
+            square--;
+        } while (binomial[square][i] > rank);
+        rank -= binomial[square][i];
+        compressed |= 1ULL << square;
+    }
+    return (unsigned int)DepositBits(compressed, ~occupied & 0xFFFFFFFFULL);
+}
+
+/**
+ * Computes a position's index within its slice
+ * @param position Compact position whose piece counts match material
+ * @param material Slice the position belongs to
+ * @return Index in [0, TBSliceSize(material))
+ */
+unsigned long long TBIndex(const CompactState* position, const TBMaterial* material) {
+    InitBinomials();
+    unsigned int occupied = 0;
+    int free_squares = 32;
+    unsigned long long index = 0;
+
+    const unsigned int sets[4] = { position->red_men, position->red_kings, position->black_men, position->black_kings };
+    const int counts[4] = { material->red_men, material->red_kings, material->black_men, material->black_kings };
+    for (int i = 0; i < 4; i++) {
+        index = index * binomial[free_squares][counts[i]] + RankSet(sets[i], occupied);
+        occupied |= sets[i];
+        free_squares -= counts[i];
+    }
+    // Side to move is the most significant part so runs of equal values stay long
+    return index + (position->current_player ? TBSliceSize(material) / 2 : 0);
+}
+
+/**
+ * Decodes an index back into a position
+ * @return 1 if the placement is legal, 0 if a man stands on its king row
+ */
+int TBUnindex(unsigned long long index, const TBMaterial* material, CompactState* position) {
+    InitBinomials();
+    const int counts[4] = { material->red_men, material->red_kings, material->black_men, material->black_kings };
+    unsigned long long ranks[4];
+    int free_after[4];
+
+    unsigned long long half = TBSliceSize(material) / 2;
+    position->current_player = index >= half;
+    if (position->current_player) index -= half;
+
+    int free_squares = 32;
+    for (int i = 0; i < 4; i++) {
+        free_after[i] = free_squares;
+        free_squares -= counts[i];
+    }
+    for (int i = 3; i >= 0; i--) {
+        unsigned long long size = binomial[free_after[i]][counts[i]];
+        ranks[i] = index % size;
+        index /= size;
+    }
+
+    unsigned int occupied = 0;
+    unsigned int* sets[4] = { &position->red_men, &position->red_kings, &position->black_men, &position->black_kings };
+    for (int i = 0; i < 4; i++) {
+        *sets[i] = UnrankSet(ranks[i], counts[i], occupied);
+        occupied |= *sets[i];
+    }
+    position->hash = 0;
+
+    return (position->red_men & ~RED_MAN_SQUARES) == 0 && (position->black_men & ~BLACK_MAN_SQUARES) == 0;
+}
+
+// File name of a slice, e.g. "tb_1102.ctb" for 1 red man, 1 red king, 2 black kings
+void TBSliceName(const TBMaterial* material, char* name, int size) {
+    snprintf(name, size, "tb_%d%d%d%d.ctb", material->red_men, material->red_kings,
+             material->black_men, material->black_kings);
+}
+
+/**
+ * Writes a solved slice, run-length compressed in independently decodable blocks
+ * @return 1 on success, 0 on I/O error
+ */
+int TBWriteSlice(const char* directory, const TBMaterial* material,
+                 const unsigned char* values, unsigned long long count) {
+    char name[64];
+    char path[1024];
+    TBSliceName(material, name, sizeof(name));
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return 0;
+
+    TBFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TB_MAGIC;
+    header.version = TB_VERSION;
+    header.red_men = material->red_men;
+    header.red_kings = material->red_kings;
+    header.black_men = material->black_men;
+    header.black_kings = material->black_kings;
+    header.entry_count = count;
+    header.block_entries = TB_BLOCK_ENTRIES;
+    header.block_count = (unsigned int)((count + TB_BLOCK_ENTRIES - 1) / TB_BLOCK_ENTRIES);
+
+    unsigned long long* offsets = malloc((header.block_count + 1) * sizeof(unsigned long long));
+    unsigned char* buffer = malloc(2 * TB_BLOCK_ENTRIES);
+    if (offsets == NULL || buffer == NULL) {
+        free(offsets);
+        free(buffer);
+        fclose(file);
+        return 0;
+    }
+
+    // Offsets are patched in after the data is written
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(offsets, sizeof(unsigned long long), header.block_count + 1, file);
+
+    unsigned long long offset = 0;
+    for (unsigned int block = 0; block < header.block_count; block++) {
+        unsigned long long start = (unsigned long long)block * TB_BLOCK_ENTRIES;
+        unsigned long long end = start + TB_BLOCK_ENTRIES < count ? start + TB_BLOCK_ENTRIES : count;
+        int length = 0;
+        for (unsigned long long i = start; i < end; ) {
+            unsigned char value = values[i];
+            int run = 1;
+            while (i + run < end && values[i + run] == value && run < 255) run++;
+            buffer[length++] = (unsigned char)run;
+            buffer[length++] = value;
+            i += run;
+        }
+        offsets[block] = offset;
+        fwrite(buffer, 1, length, file);
+        offset += length;
+    }
+    offsets[header.block_count] = offset;
+
+    fseek(file, sizeof(header), SEEK_SET);
+    fwrite(offsets, sizeof(unsigned long long), header.block_count + 1, file);
+    int ok = !ferror(file);
+    fclose(file);
+
+    free(offsets);
+    free(buffer);
+    return ok;
+}
+
+/**
+ * Checks a mapped file's block table against its size, so probing a
+ * truncated or damaged file can never read outside the mapping
+ * @return 1 if every block lies inside the file and holds whole (run, value) pairs
+ */
+static int ValidBlocks(const TBFileHeader* header, const unsigned char* map, size_t size) {
+    unsigned long long blocks = (header->entry_count + TB_BLOCK_ENTRIES - 1) / TB_BLOCK_ENTRIES;
+    if (header->block_count != blocks) return 0;
+
+    size_t table_end = sizeof(TBFileHeader) + (blocks + 1) * sizeof(unsigned long long);
+    if (table_end > size) return 0;
+    const unsigned long long* offsets = (const unsigned long long*)(map + sizeof(TBFileHeader));
+    unsigned long long data_size = size - table_end;
+
+    if (offsets[0] != 0 || offsets[blocks] > data_size) return 0;
+    for (unsigned long long block = 0; block < blocks; block++) {
+        unsigned long long length = offsets[block + 1] - offsets[block];
+        if (offsets[block + 1] < offsets[block] || length % 2 != 0 || length > 2 * TB_BLOCK_ENTRIES) return 0;
+    }
+    return 1;
+}
+
+// Maps a slice file; the OS pages blocks in only when they are probed
+static void MapSlice(TBSlice* slice, const TBMaterial* material) {
+    char name[64];
+    char path[1024];
+    TBSliceName(material, name, sizeof(name));
+    snprintf(path, sizeof(path), "%s/%s", tb_directory, name);
+
+    slice->state = SLICE_MISSING;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TBFileHeader)) {
+        close(fd);
+        return;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return;
+
+    const TBFileHeader* header = map;
+    if (header->magic != TB_MAGIC || header->version != TB_VERSION ||
+        header->block_entries != TB_BLOCK_ENTRIES || header->entry_count != TBSliceSize(material) ||
+        !ValidBlocks(header, map, info.st_size)) {
+        munmap(map, info.st_size);
+        return;
+    }
+
+    slice->map = map;
+    slice->map_size = info.st_size;
+    slice->offsets = (const unsigned long long*)(slice->map + sizeof(TBFileHeader));
+    slice->data = (const unsigned char*)(slice->offsets + header->block_count + 1);
+    slice->entry_count = header->entry_count;
+    slice->state = SLICE_MAPPED;
+}
+
+/**
+ * Selects the directory holding database files
+ * Files are opened lazily by TBProbe; this only finds the largest piece count present.
+ * @param directory Directory containing tb_*.ctb files
+ * @return Largest total piece count available (0 if none)
+ */
+int TBInit(const char* directory) {
+    TBClose();
+    InitBinomials();
+    snprintf(tb_directory, sizeof(tb_directory), "%s", directory);
+
+    char name[64];
+    char path[1024];
+    for (int total = 2; total <= TB_MAX_PIECES; total++) {
+        int found = 0;
+        for (int rm = 0; rm <= total && !found; rm++) {
+            for (int rk = 0; rm + rk <= total && !found; rk++) {
+                for (int bm = 0; rm + rk + bm <= total && !found; bm++) {
+                    TBMaterial material = { rm, rk, bm, total - rm - rk - bm };
+                    TBSliceName(&material, name, sizeof(name));
+                    snprintf(path, sizeof(path), "%s/%s", directory, name);
+                    found = access(path, R_OK) == 0;
+                }
+            }
+        }
+        if (found) tb_max_pieces = total;
+    }
+    return tb_max_pieces;
+}
+
+// Unmaps every slice and forgets the directory
+void TBClose(void) {
+    pthread_mutex_lock(&slice_lock);
+    for (int rm = 0; rm <= TB_MAX_PIECES; rm++)
+        for (int rk = 0; rk <= TB_MAX_PIECES; rk++)
+            for (int bm = 0; bm <= TB_MAX_PIECES; bm++)
+                for (int bk = 0; bk <= TB_MAX_PIECES; bk++) {
+                    TBSlice* slice = &slices[rm][rk][bm][bk];
+                    if (slice->state == SLICE_MAPPED) munmap((void*)slice->map, slice->map_size);
+                    memset(slice, 0, sizeof(*slice));
+                }
+    tb_max_pieces = 0;
+    pthread_mutex_unlock(&slice_lock);
+}
+
+// Largest piece count TBProbe can answer for (0 if no databases are loaded)
+int TBMaxPieces(void) {
+    return tb_max_pieces;
+}
+
+// Reads one value out of a compressed block
+static unsigned char ReadValue(const TBSlice* slice, unsigned long long index) {
+    unsigned long long block = index / TB_BLOCK_ENTRIES;
+    unsigned long long skip = index % TB_BLOCK_ENTRIES;
+    const unsigned char* run = slice->data + slice->offsets[block];
+    const unsigned char* end = slice->data + slice->offsets[block + 1];
+
+    while (run < end) {
+        if (skip < run[0]) return run[1];
+        skip -= run[0];
+        run += 2;
+    }
+    return TB_VALUE_DRAW;
+}
+
+/**
+ * Looks a position up in the databases
+ * @param game Position to probe
+ * @param result Output: TB_WIN, TB_DRAW or TB_LOSS for the side to move
+ * @param distance Output: plies to the end of the game with best play (0 for draws)
+ * @return 1 if the position was found, 0 if no database covers it
+ */
+int TBProbe(const GameState* game, int* result, int* distance) {
+    unsigned long long red = game->red_pieces | game->red_kings;
+    unsigned long long black = game->black_pieces | game->black_kings;
+    if (tb_max_pieces == 0 || CountBits(red | black) > tb_max_pieces || !red || !black) return 0;
+
+    CompactState position;
+    PackState(game, &position);
+    TBMaterial material;
+    TBGetMaterial(&position, &material);
+
+    TBSlice* slice = &slices[material.red_men][material.red_kings][material.black_men][material.black_kings];
+    if (__atomic_load_n(&slice->state, __ATOMIC_ACQUIRE) == SLICE_UNKNOWN) {
+        pthread_mutex_lock(&slice_lock);
+        if (slice->state == SLICE_UNKNOWN) {
+            TBSlice mapped;
+            memset(&mapped, 0, sizeof(mapped));
+            MapSlice(&mapped, &material);
+            int state = mapped.state;
+            mapped.state = SLICE_UNKNOWN;
+            *slice = mapped;
+            __atomic_store_n(&slice->state, state, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&slice_lock);
+    }
+    if (slice->state != SLICE_MAPPED) return 0;
+
+    unsigned char value = ReadValue(slice, TBIndex(&position, &material));
+    if (value == TB_VALUE_DRAW) {
+        *result = TB_DRAW;
+        *distance = 0;
+    } else {
+        *result = TB_IS_WIN(value) ? TB_WIN : TB_LOSS;
+        *distance = TB_DISTANCE(value);
+    }
+    return 1;
+}
@@ -0,0 +1,52 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "board.h"
+#include "board32.h"
+
+// Largest piece count a database can be indexed for
+#define TB_MAX_PIECES 8
+
+// Entries per compressed block (random access unit)
+#define TB_BLOCK_ENTRIES 4096
+
+// One byte per position: 0 = draw, otherwise distance + 1 in plies,
+// where an even distance is a loss and an odd distance a win for the side to move
+#define TB_VALUE_DRAW 0
+#define TB_VALUE(distance) ((unsigned char)((distance) + 1))
+#define TB_DISTANCE(value) ((int)(value) - 1)
+#define TB_IS_WIN(value)   ((value) != 0 && ((value) % 2) == 0)
+#define TB_IS_LOSS(value)  ((value) != 0 && ((value) % 2) == 1)
+#define TB_MAX_DISTANCE 254
+
+// Probe outcomes, from the side to move's point of view
+#define TB_LOSS -1
+#define TB_DRAW  0
+#define TB_WIN   1
+
+// Piece counts identifying one database slice
+typedef struct {
+    int red_men;
+    int red_kings;
+    int black_men;
+    int black_kings;
+} TBMaterial;
+
+// Indexing (perfect: every index decodes to a distinct placement)
+void TBGetMaterial(const CompactState* position, TBMaterial* material);
+unsigned long long TBSliceSize(const TBMaterial* material);
+unsigned long long TBIndex(const CompactState* position, const TBMaterial* material);
+int TBUnindex(unsigned long long index, const TBMaterial* material, CompactState* position);
+void TBSliceName(const TBMaterial* material, char* name, int size);
+
+// Writing a solved slice as a block-compressed file
+int TBWriteSlice(const char* directory, const TBMaterial* material,
+                 const unsigned char* values, unsigned long long count);
+
+// Probing (files are memory mapped on first use)
+int TBInit(const char* directory);
+void TBClose(void);
+int TBMaxPieces(void);
+int TBProbe(const GameState* game, int* result, int* distance);
+
+#endif // TABLEBASE_H
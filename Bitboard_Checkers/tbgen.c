@@ -0,0 +1,234 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "board.h"
+#include "board32.h"
+#include "movegen.h"
+#include "tablebase.h"
+
+// Indices handed to a worker at a time
+#define CHUNK_SIZE 4096
+
+// Solved slices stay in memory: captures and promotions look their successors up here
+static unsigned char* solved[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1];
+
+// The slice being generated and the pass the workers are running
+typedef struct {
+    TBMaterial material;
+    unsigned char* values;
+    unsigned long long size;
+    int pass;                           // 0 = mark terminal positions, n = assign results at distance n
+    unsigned long long next_index;      // Shared chunk counter
+    unsigned long long changed;         // Positions resolved during this pass
+} Job;
+
+static Job job;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Database value of a position reached by a move (it must belong to a solved slice or the current one)
+static unsigned char SuccessorValue(const GameState* game) {
+    unsigned long long red = game->red_pieces | game->red_kings;
+    unsigned long long black = game->black_pieces | game->black_kings;
+
+    // Losing the last piece is a loss in 0 for the side to move
+    if (!(game->current_player == 0 ? red : black)) return TB_VALUE(0);
+
+    CompactState position;
+    TBMaterial material;
+    PackState(game, &position);
+    TBGetMaterial(&position, &material);
+    const unsigned char* values =
+        solved[material.red_men][material.red_kings][material.black_men][material.black_kings];
+    return values[TBIndex(&position, &material)];
+}
+
+/**
+ * Tries to resolve one position in the current pass
+ * A position is a win in n if some move reaches a loss in n-1, and a loss
+ * in n if every move reaches a win and the longest of them is n-1. Values
+ * written during pass n have distance n, which never satisfies either test
+ * in the same pass, so the order positions are visited in does not matter.
+ * @return The new value, or TB_VALUE_DRAW if still unresolved
+ */
+static unsigned char ResolvePosition(unsigned long long index) {
+    CompactState position;
+    if (!TBUnindex(index, &job.material, &position)) return TB_VALUE_DRAW;
+
+    GameState game;
+    UnpackState(&position, &game);
+    MoveList list;
+    GenerateMoves(&game, &list);
+
+    if (job.pass == 0) {
+        return list.count == 0 ? TB_VALUE(0) : TB_VALUE_DRAW;
+    }
+
+    int all_wins = 1;
+    int longest_win = 0;
+    for (int i = 0; i < list.count; i++) {
+        DoMove(&game, &list.moves[i]);
+        unsigned char value = SuccessorValue(&game);
+        UndoMove(&game, &list.moves[i]);
+
+        if (TB_IS_LOSS(value) && TB_DISTANCE(value) == job.pass - 1) return TB_VALUE(job.pass);
+        if (!TB_IS_WIN(value) || TB_DISTANCE(value) >= job.pass) {
+            all_wins = 0;
+        } else if (TB_DISTANCE(value) > longest_win) {
+            longest_win = TB_DISTANCE(value);
+        }
+    }
+    if (all_wins && list.count > 0 && longest_win == job.pass - 1) return TB_VALUE(job.pass);
+    return TB_VALUE_DRAW;
+}
+
+// Worker: claims chunks of indices until the slice is covered
+static void* PassWorker(void* arg) {
+    (void)arg;
+    unsigned long long changed = 0;
+    for (;;) {
+        unsigned long long start = __atomic_fetch_add(&job.next_index, CHUNK_SIZE, __ATOMIC_RELAXED);
+        if (start >= job.size) break;
+        unsigned long long end = start + CHUNK_SIZE < job.size ? start + CHUNK_SIZE : job.size;
+
+        for (unsigned long long index = start; index < end; index++) {
+            if (job.values[index] != TB_VALUE_DRAW) continue;
+            unsigned char value = ResolvePosition(index);
+            if (value != TB_VALUE_DRAW) {
+                job.values[index] = value;
+                changed++;
+            }
+        }
+    }
+    __atomic_fetch_add(&job.changed, changed, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Runs one pass over the current slice on up to thread_count threads
+// Indices are claimed in chunks, so threads that cannot be started only cost speed
+static unsigned long long RunPass(int pass, int thread_count) {
+    // Heap-allocated: the count comes from the command line; without it this thread works alone
+    pthread_t* workers = malloc(thread_count * sizeof(pthread_t));
+    job.pass = pass;
+    job.next_index = 0;
+    job.changed = 0;
+
+    int started = 1;
+    while (workers != NULL && started < thread_count &&
+           pthread_create(&workers[started], NULL, PassWorker, NULL) == 0) {
+        started++;
+    }
+    PassWorker(NULL);
+    for (int i = 1; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    return job.changed;
+}
+
+/**
+ * Solves one slice by retrograde passes and writes it out
+ * Results in smaller slices can be far away, so passes continue until
+ * nothing changes and the pass number has passed every known distance.
+ * @param longest Longest distance found in any slice so far (updated)
+ * @return 1 on success, 0 on allocation or I/O failure
+ */
+static int SolveSlice(const TBMaterial* material, const char* directory, int thread_count, int* longest) {
+    char name[64];
+    TBSliceName(material, name, sizeof(name));
+
+    job.material = *material;
+    job.size = TBSliceSize(material);
+    job.values = calloc(job.size, 1);
+    if (job.values == NULL) {
+        printf("Error: Could not allocate %llu bytes for %s!\n", job.size, name);
+        return 0;
+    }
+    solved[material->red_men][material->red_kings][material->black_men][material->black_kings] = job.values;
+
+    double start = Now();
+    int pass = 0;
+    int slice_longest = 0;
+    for (;;) {
+        unsigned long long changed = RunPass(pass, thread_count);
+        if (changed > 0) slice_longest = pass;
+        if (changed == 0 && pass > *longest + 1) break;
+        if (++pass > TB_MAX_DISTANCE) {
+            printf("Error: %s has results longer than %d plies, which the database format cannot store!\n",
+                   name, TB_MAX_DISTANCE);
+            return 0;
+        }
+    }
+    if (slice_longest > *longest) *longest = slice_longest;
+
+    unsigned long long wins = 0, losses = 0, draws = 0;
+    CompactState position;
+    for (unsigned long long index = 0; index < job.size; index++) {
+        unsigned char value = job.values[index];
+        if (TB_IS_WIN(value)) wins++;
+        else if (TB_IS_LOSS(value)) losses++;
+        else if (TBUnindex(index, material, &position)) draws++;
+    }
+
+    if (!TBWriteSlice(directory, material, job.values, job.size)) {
+        printf("Error: Could not write %s/%s!\n", directory, name);
+        return 0;
+    }
+    printf("%-14s %12llu %12llu %12llu %12llu %7d %8.2fs\n", name, job.size, wins, losses, draws,
+           slice_longest, Now() - start);
+    fflush(stdout);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    InitBitops();
+
+    int max_pieces = argc > 1 ? atoi(argv[1]) : 0;
+    const char* directory = argc > 2 ? argv[2] : "tablebase";
+    int thread_count = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (max_pieces < 2 || max_pieces > TB_MAX_PIECES || thread_count <= 0) {
+        printf("Usage: %s <max_pieces> [directory] [threads]\n", argv[0]);
+        printf("Generates endgame databases for 2 to %d pieces.\n", TB_MAX_PIECES);
+        return 1;
+    }
+    // Passes are CPU-bound, so more threads than cores only add start-up cost
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0 && thread_count > cores) {
+        printf("Warning: %d threads requested, using %d (one per core)\n", thread_count, cores);
+        thread_count = cores;
+    }
+    mkdir(directory, 0755);
+
+    printf("Endgame databases up to %d pieces in %s/ (%d threads)\n\n", max_pieces, directory, thread_count);
+    printf("Slice             Positions         Wins       Losses        Draws Longest     Time\n");
+
+    // Fewer pieces first (captures), then fewer men (promotions), so every successor is solved
+    double start = Now();
+    int longest = 0;
+    for (int total = 2; total <= max_pieces; total++) {
+        for (int men = 0; men <= total; men++) {
+            for (int red = 1; red < total; red++) {
+                int black = total - red;
+                for (int red_men = 0; red_men <= red && red_men <= men; red_men++) {
+                    int black_men = men - red_men;
+                    if (black_men > black) continue;
+                    TBMaterial material = { red_men, red - red_men, black_men, black - black_men };
+                    if (!SolveSlice(&material, directory, thread_count, &longest)) return 1;
+                }
+            }
+        }
+    }
+
+    printf("\nDone in %.2fs, longest result %d plies\n", Now() - start, longest);
+    return 0;
+}
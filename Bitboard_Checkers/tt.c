@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tt.h"
+
+// Layout of TTEntry.data:
+//   bits  0-7   depth
+//   bits  8-13  generation
+//   bits 14-15  bound (0 = perft count)
+//   bits 16-63  payload: search = move (16) | score (16) | move check (16),
+//                        perft = count (48)
+#define DEPTH_BITS(d)       ((unsigned long long)((d) & 0xFF))
+#define GENERATION_BITS(g)  ((unsigned long long)((g) & 0x3F) << 8)
+#define BOUND_BITS(b)       ((unsigned long long)((b) & 0x3) << 14)
+#define PAYLOAD_SHIFT       16
+#define PERFT_COUNT_LIMIT   (1ULL << 48)
+
+#define ENTRY_DEPTH(data)       ((int)((data) & 0xFF))
+#define ENTRY_GENERATION(data)  ((int)(((data) >> 8) & 0x3F))
+#define ENTRY_BOUND(data)       ((int)(((data) >> 14) & 0x3))
+
+static TTBucket* table = NULL;
+static unsigned long long bucket_mask = 0;
+static int table_mb = 0;
+static int generation = 0;               // Current search, shared by every thread
+
+// Relaxed atomic accesses: entries are verified, not locked
+static unsigned long long LoadWord(const unsigned long long* word) {
+    return __atomic_load_n(word, __ATOMIC_RELAXED);
+}
+
+static void StoreWord(unsigned long long* word, unsigned long long value) {
+    __atomic_store_n(word, value, __ATOMIC_RELAXED);
+}
+
+static int CurrentGeneration(void) {
+    return __atomic_load_n(&generation, __ATOMIC_RELAXED);
+}
+
+/**
+ * Allocates the table, rounding the size down to a power-of-two bucket count
+ * @param size_mb Table size in megabytes (at least 1)
+ * @return 1 on success, 0 if the memory could not be allocated
+ */
+int TTInit(int size_mb) {
+    if (size_mb < 1) size_mb = 1;
+    TTFree();
+
+    unsigned long long buckets = 1;
+    while (buckets * 2 * sizeof(TTBucket) <= (unsigned long long)size_mb << 20) {
+        buckets *= 2;
+    }
+
+    table = aligned_alloc(64, buckets * sizeof(TTBucket));
+    if (table == NULL) return 0;
+
+    bucket_mask = buckets - 1;
+    table_mb = (int)((buckets * sizeof(TTBucket)) >> 20);
+    TTClear();
+    return 1;
+}
+
+// Releases the table
+void TTFree(void) {
+    free(table);
+    table = NULL;
+    bucket_mask = 0;
+    table_mb = 0;
+}
+
+// Wipes every entry
+void TTClear(void) {
+    if (table) memset(table, 0, (bucket_mask + 1) * sizeof(TTBucket));
+    __atomic_store_n(&generation, 0, __ATOMIC_RELAXED);
+}
+
+// Ages existing entries so a new search prefers to overwrite them
+// Called by whoever owns the table between searches, not by each searcher
+void TTNewSearch(void) {
+    __atomic_store_n(&generation, (CurrentGeneration() + 1) & 0x3F, __ATOMIC_RELAXED);
+}
+
+// Returns the allocated size in megabytes (0 if no table)
+int TTSizeMB(void) {
+    return table_mb;
+}
+
+// Finds a verified entry for key in its bucket; returns its data or 0
+static int FindEntry(unsigned long long key, unsigned long long* data) {
+    if (table == NULL) return 0;
+
+    TTBucket* bucket = &table[key & bucket_mask];
+    for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        unsigned long long entry_data = LoadWord(&bucket->entries[i].data);
+        unsigned long long entry_key = LoadWord(&bucket->entries[i].key_xor_data) ^ entry_data;
+        if (entry_key == key && entry_data != 0) {
+            *data = entry_data;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Writes an entry with depth-preferred replacement
+ * The same key is overwritten in place unless the stored result is deeper
+ * and current. Otherwise the shallowest entry is evicted, with entries from
+ * older searches counting as shallower.
+ */
+static void WriteEntry(unsigned long long key, unsigned long long data) {
+    if (table == NULL) return;
+
+    TTBucket* bucket = &table[key & bucket_mask];
+    TTEntry* victim = NULL;
+    int victim_worth = 0x7FFFFFFF;
+    int current = CurrentGeneration();
+
+    for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        TTEntry* entry = &bucket->entries[i];
+        unsigned long long entry_data = LoadWord(&entry->data);
+        unsigned long long entry_key = LoadWord(&entry->key_xor_data) ^ entry_data;
+
+        if (entry_key == key) {
+            int stale = ENTRY_GENERATION(entry_data) != current;
+            if (ENTRY_DEPTH(entry_data) > ENTRY_DEPTH(data) && !stale &&
+                ENTRY_BOUND(data) != TT_EXACT) {
+                return;
+            }
+            victim = entry;
+            break;
+        }
+
+        int age = (current - ENTRY_GENERATION(entry_data)) & 0x3F;
+        int worth = ENTRY_DEPTH(entry_data) - 8 * age;
+        if (entry_data == 0) worth = -0x7FFFFFFF;
+        if (worth < victim_worth) {
+            victim_worth = worth;
+            victim = entry;
+        }
+    }
+
+    StoreWord(&victim->key_xor_data, key ^ data);
+    StoreWord(&victim->data, data);
+}
+
+/**
+ * Looks up a search result
+ * @param key Zobrist key of the position
+ * @param out Output: depth, bound, score and best move code
+ * @return 1 if found, 0 otherwise
+ */
+int TTProbe(unsigned long long key, TTData* out) {
+    unsigned long long data;
+    if (!FindEntry(key, &data) || ENTRY_BOUND(data) == 0) return 0;
+
+    out->depth = ENTRY_DEPTH(data);
+    out->bound = ENTRY_BOUND(data);
+    out->move = (unsigned int)((data >> PAYLOAD_SHIFT) & 0xFFFF) | (unsigned int)(data >> 48) << 16;
+    out->score = (short)(data >> (PAYLOAD_SHIFT + 16));
+    return 1;
+}
+
+// Stores a search result (depth is clamped to 0-255, score to 16 bits)
+void TTStore(unsigned long long key, int depth, int score, int bound, unsigned int move) {
+    if (depth < 0) depth = 0;
+    if (depth > 255) depth = 255;
+
+    unsigned long long data = DEPTH_BITS(depth) | GENERATION_BITS(CurrentGeneration()) | BOUND_BITS(bound) |
+                              ((unsigned long long)(move & 0xFFFF) << PAYLOAD_SHIFT) |
+                              ((unsigned long long)(unsigned short)score << (PAYLOAD_SHIFT + 16)) |
+                              ((unsigned long long)(move >> 16) << 48);
+    WriteEntry(key, data);
+}
+
+// Looks up a perft node count stored for exactly this depth
+int TTProbePerft(unsigned long long key, int depth, unsigned long long* count) {
+    unsigned long long data;
+    if (!FindEntry(key, &data) || ENTRY_BOUND(data) != 0 || ENTRY_DEPTH(data) != depth) return 0;
+
+    *count = data >> PAYLOAD_SHIFT;
+    return 1;
+}
+
+// Stores a perft node count (counts too large to fit are skipped)
+void TTStorePerft(unsigned long long key, int depth, unsigned long long count) {
+    if (count >= PERFT_COUNT_LIMIT || depth > 255) return;
+
+    unsigned long long data = DEPTH_BITS(depth) | GENERATION_BITS(CurrentGeneration()) | BOUND_BITS(0) |
+                              (count << PAYLOAD_SHIFT);
+    WriteEntry(key, data);
+}
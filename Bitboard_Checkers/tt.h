@@ -0,0 +1,48 @@
+#ifndef TT_H
+#define TT_H
+
+// Bound types stored with search results
+#define TT_UPPER 1      // Score is at most the stored value (failed low)
+#define TT_LOWER 2      // Score is at least the stored value (failed high)
+#define TT_EXACT 3      // Score is exact
+
+// Default table size
+#define TT_DEFAULT_MB 64
+
+// One slot of a bucket: the key is stored XORed with the data, so a torn
+// write from another thread fails verification instead of returning garbage
+typedef struct {
+    unsigned long long key_xor_data;
+    unsigned long long data;
+} TTEntry;
+
+// Four entries fill exactly one 64-byte cache line
+#define TT_BUCKET_ENTRIES 4
+typedef struct {
+    TTEntry entries[TT_BUCKET_ENTRIES];
+} __attribute__((aligned(64))) TTBucket;
+
+// Search result read back from the table
+typedef struct {
+    int depth;
+    int bound;
+    int score;
+    unsigned int move;          // Move code, with 16 check bits above it
+} TTData;
+
+// Table management (one table shared by search, perft and analysis)
+int TTInit(int size_mb);
+void TTFree(void);
+void TTClear(void);
+void TTNewSearch(void);
+int TTSizeMB(void);
+
+// Search entries
+int TTProbe(unsigned long long key, TTData* out);
+void TTStore(unsigned long long key, int depth, int score, int bound, unsigned int move);
+
+// Perft entries (node counts below 2^48)
+int TTProbePerft(unsigned long long key, int depth, unsigned long long* count);
+void TTStorePerft(unsigned long long key, int depth, unsigned long long count);
+
+#endif // TT_H
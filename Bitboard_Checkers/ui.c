@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <unistd.h>
+#include "ui.h"
+#include "archive.h"
+#include "bitops.h"
+#include "board.h"
+#include "book.h"
+#include "game.h"
+#include "history.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "render.h"
+#include "tablebase.h"
+
+// Room for the board display; the frame grows if it ever needs more
+#define BOARD_FRAME_SIZE 4096
+
+// Displays the game board with a nice visual layout, composed in memory and
+// written with a single call
+void DisplayBoard(GameState* game) {
+    static Frame frame;
+    if (frame.data == NULL && !FrameInit(&frame, BOARD_FRAME_SIZE)) return;
+
+    FrameClear(&frame);
+    RenderBoard(&frame, game);
+    fflush(stdout);
+    FrameWrite(&frame, STDOUT_FILENO);
+}
+
+// Returns the message shown to the player for a rejected move
+static const char* MoveStatusMessage(MoveStatus status) {
+    switch (status) {
+        case MOVE_ERROR_INVALID_POSITION:     return "Invalid position! Must be on dark squares.";
+        case MOVE_ERROR_NOT_OWN_PIECE:        return "No piece at that position or not your piece!";
+        case MOVE_ERROR_DESTINATION_OCCUPIED: return "Destination is not empty!";
+        case MOVE_ERROR_RED_BACKWARD:         return "Regular red pieces must move forward (up)!";
+        case MOVE_ERROR_BLACK_BACKWARD:       return "Regular black pieces must move forward (down)!";
+        case MOVE_ERROR_NO_CAPTURE:           return "No opponent piece to capture!";
+        case MOVE_ERROR_INCOMPLETE_JUMP:      return "More jumps are available! Enter the final square of the whole jump sequence.";
+        case MOVE_ERROR_CAPTURE_REQUIRED:     return "A capture is available - you must jump!";
+        case MOVE_ERROR_AMBIGUOUS_JUMP:       return "Several jump sequences end there! Enter every landing square, e.g. 2 1 4 3 6 5.";
+        case MOVE_ERROR_INVALID_MOVE:         return "Invalid move! Pieces move diagonally 1 or 2 squares.";
+        default:                              return "";
+    }
+}
+
+// Announces a move's EVENT_* flags: each captured piece, then a promotion of player's piece
+static void ReportMoveEvents(int events, int captures, int player) {
+    if (events & EVENT_CAPTURE) {
+        for (int i = 0; i < captures; i++) {
+            printf("💥 Piece captured! 💥\n");
+        }
+    }
+    if (events & EVENT_PROMOTION) {
+        printf("🎉 %s piece promoted to KING! 🎉\n", player == 0 ? "Red" : "Black");
+    }
+}
+
+// Counts every piece on the board
+static int PieceCount(const GameState* game) {
+    return CountBits(game->red_pieces | game->red_kings | game->black_pieces | game->black_kings);
+}
+
+/**
+ * Plays a move typed by a player, explaining why if it is rejected
+ * @return 1 if the move was played, 0 otherwise
+ */
+int UIMakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col) {
+    int player = game->current_player;
+    int pieces = PieceCount(game);
+    int events;
+    MoveStatus status = MakeMove(game, from_row, from_col, to_row, to_col, &events);
+    if (status != MOVE_OK) {
+        printf("%s\n", MoveStatusMessage(status));
+        return 0;
+    }
+    // The events come from the rules code; the piece count only says how many were taken
+    ReportMoveEvents(events, pieces - PieceCount(game), player);
+    return 1;
+}
+
+// Plays a generated move (e.g. the engine's choice) and announces its events
+void UIExecuteMove(GameState* game, const Move* move) {
+    int player = game->current_player;
+    int events = ExecuteMove(game, move);
+    ReportMoveEvents(events, CountBits(move->captured), player);
+}
+
+// Checks for a winner and shows the victory banner
+// Returns the result, RESULT_NONE while the game goes on
+GameResult UICheckWinCondition(GameState* game, const GameHistory* history) {
+    GameResult result = CheckWinCondition(game, history);
+    
+    if (result == RESULT_BLACK_WINS) {
+        printf("\n");
+        printf("  ╔═══════════════════════════════════════╗\n");
+        printf("  ║                                       ║\n");
+        printf("  ║          🏆 BLACK WINS! 🏆           ║\n");
+        printf("  ║                                       ║\n");
+        printf("  ║      CONGRATULATIONS BLACK PLAYER!    ║\n");
+        printf("  ║                                       ║\n");
+        printf("  ╚═══════════════════════════════════════╝\n");
+        printf("\n");
+    } else if (result == RESULT_RED_WINS) {
+        printf("\n");
+        printf("  ╔═══════════════════════════════════════╗\n");
+        printf("  ║                                       ║\n");
+        printf("  ║           🏆 RED WINS! 🏆            ║\n");
+        printf("  ║                                       ║\n");
+        printf("  ║       CONGRATULATIONS RED PLAYER!     ║\n");
+        printf("  ║                                       ║\n");
+        printf("  ╚═══════════════════════════════════════╝\n");
+        printf("\n");
+    } else if (result == RESULT_DRAW) {
+        printf("\n");
+        printf("  ╔═══════════════════════════════════════╗\n");
+        printf("  ║                                       ║\n");
+        printf("  ║            🤝 DRAW GAME 🤝            ║\n");
+        printf("  ║                                       ║\n");
+        if (HistoryRepetitions(history) >= DRAW_REPETITIONS - 1) {
+            printf("  ║    SAME POSITION THREE TIMES          ║\n");
+        } else {
+            printf("  ║    %d MOVES WITHOUT CAPTURE OR MAN    ║\n", DRAW_QUIET_PLIES / 2);
+        }
+        printf("  ║                                       ║\n");
+        printf("  ╚═══════════════════════════════════════╝\n");
+        printf("\n");
+    }
+    
+    return result;
+}
+
+// Saves the game and reports the outcome; returns 1 on success
+int UISaveGame(GameState* game, const char* filename) {
+    if (SaveGame(game, filename) != FILE_OK) {
+        printf("Error: Could not open file for saving!\n");
+        return 0;
+    }
+    printf("✓ Game saved successfully to '%s'\n", filename);
+    return 1;
+}
+
+// Loads a game and reports the outcome; returns 1 on success
+int UILoadGame(GameState* game, const char* filename) {
+    FileStatus status = LoadGame(game, filename);
+    if (status == FILE_ERROR_OPEN) {
+        printf("Error: Could not open file for loading!\n");
+        return 0;
+    }
+    if (status == FILE_ERROR_FORMAT) {
+        printf("Error: Invalid save file format!\n");
+        return 0;
+    }
+    if (status == FILE_ERROR_POSITION) {
+        printf("Error: Save file holds an impossible position!\n");
+        return 0;
+    }
+    printf("✓ Game loaded successfully from '%s'\n", filename);
+    return 1;
+}
+
+// Describes a failed binary file operation
+static const char* FileStatusMessage(FileStatus status) {
+    switch (status) {
+        case FILE_ERROR_OPEN:     return "Error: Could not open file!";
+        case FILE_ERROR_FORMAT:   return "Error: Invalid or damaged game file!";
+        case FILE_ERROR_POSITION: return "Error: File holds an impossible position!";
+        case FILE_ERROR_WRITE:    return "Error: Could not write file!";
+        default:                  return "Error: Unknown file error!";
+    }
+}
+
+// Saves the game with its move history in the binary format; returns 1 on success
+int UISaveRecord(const GameRecord* record, const char* filename) {
+    FileStatus status = SaveGameBinary(record, filename);
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+    printf("✓ Game saved successfully to '%s' (%d moves)\n", filename, record->ply_count);
+    return 1;
+}
+
+// Loads a binary game file and replays it to its last move; returns 1 on success
+int UILoadRecord(GameState* game, GameRecord* record, const char* filename) {
+    GameRecord loaded;
+    FileStatus status = LoadGameBinary(&loaded, filename);
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+    if (RecordReplay(&loaded, loaded.ply_count, game) != loaded.ply_count) {
+        printf("Warning: Moves after the first illegal one were dropped\n");
+    }
+    *record = loaded;
+    printf("✓ Game loaded successfully from '%s' (%d moves)\n", filename, record->ply_count);
+    return 1;
+}
+
+// Appends the game to an archive and reports its number; returns 1 on success
+int UIArchiveGame(const GameRecord* record, const char* path) {
+    ArchiveWriter writer;
+    unsigned long long number;
+    FileStatus status = ArchiveWriterOpen(&writer, path);
+    if (status == FILE_OK) {
+        status = ArchiveAppend(&writer, record, &number);
+        FileStatus closed = ArchiveWriterClose(&writer);
+        if (status == FILE_OK) status = closed;
+    }
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+    printf("✓ Game stored as #%llu in '%s'\n", number, path);
+    return 1;
+}
+
+// Loads game number from an archive and replays it; returns 1 on success
+int UIReplayGame(GameState* game, GameRecord* record, const char* path, unsigned long long number) {
+    Archive archive;
+    FileStatus status = ArchiveOpen(&archive, path);
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+
+    GameRecord loaded;
+    unsigned long long count = archive.count;
+    int found = ArchiveGetGame(&archive, number, &loaded);
+    ArchiveClose(&archive);
+    if (!found) {
+        printf("Error: '%s' holds %llu games (0-%llu)!\n", path, count, count > 0 ? count - 1 : 0);
+        return 0;
+    }
+
+    if (RecordReplay(&loaded, loaded.ply_count, game) != loaded.ply_count) {
+        printf("Warning: Moves after the first illegal one were dropped\n");
+    }
+    *record = loaded;
+    printf("✓ Game #%llu loaded from '%s' (%d moves)\n", number, path, record->ply_count);
+    return 1;
+}
+
+// Prints the endgame database verdict for the position, if one is known
+void UIReportTablebase(const GameState* game) {
+    int result, distance;
+    if (!TBProbe(game, &result, &distance)) return;
+
+    const char* side = game->current_player == 0 ? "RED" : "BLACK";
+    const char* other = game->current_player == 0 ? "BLACK" : "RED";
+    if (result == TB_WIN) {
+        printf("Tablebase: %s wins in %d plies\n", side, distance);
+    } else if (result == TB_LOSS) {
+        printf("Tablebase: %s wins in %d plies\n", other, distance);
+    } else {
+        printf("Tablebase: draw with best play\n");
+    }
+}
+
+// Switches the search to an evaluation network file; returns 1 on success
+int UILoadNetwork(const char* filename) {
+    FileStatus status = NNUELoad(filename);
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+    printf("✓ Evaluation network loaded from '%s'\n", filename);
+    return 1;
+}
+
+// Lists the opening book's moves for the position, if it has any
+void UIReportBook(const GameState* game) {
+    const BookEntry* entries;
+    int count = BookProbe(game, &entries);
+    if (count == 0) return;
+
+    MoveList list;
+    GenerateMoves(game, &list);
+    printf("Book:");
+    for (int i = 0; i < count; i++) {
+        // Entries naming no legal move, or several captures, are not shown
+        const Move* move = FindEncodedMove(&list, entries[i].move);
+        if (move == NULL) continue;
+        printf("  %d %d -> %d %d (%u games, %.0f%%)", move->from / 8, move->from % 8, move->to / 8, move->to % 8,
+               entries[i].games, 100.0 * (entries[i].wins + 0.5 * entries[i].draws) / entries[i].games);
+    }
+    printf("\n");
+}
+
+// Switches to another opening book file; returns 1 on success
+int UILoadBook(const char* filename) {
+    FileStatus status = BookInit(filename);
+    if (status != FILE_OK) {
+        printf("%s\n", FileStatusMessage(status));
+        return 0;
+    }
+    printf("✓ Opening book loaded from '%s' (%llu moves)\n", filename, BookSize());
+    return 1;
+}
@@ -0,0 +1,27 @@
+#ifndef UI_H
+#define UI_H
+
+#include "archive.h"
+#include "board.h"
+#include "game.h"
+#include "history.h"
+#include "movegen.h"
+
+// Terminal front-end: the rules library never prints, these functions
+// turn its status codes and events into messages for the player
+void DisplayBoard(GameState* game);
+int UIMakeMove(GameState* game, int from_row, int from_col, int to_row, int to_col);
+void UIExecuteMove(GameState* game, const Move* move);
+GameResult UICheckWinCondition(GameState* game, const GameHistory* history);
+int UISaveGame(GameState* game, const char* filename);
+int UILoadGame(GameState* game, const char* filename);
+int UISaveRecord(const GameRecord* record, const char* filename);
+int UILoadRecord(GameState* game, GameRecord* record, const char* filename);
+int UIArchiveGame(const GameRecord* record, const char* path);
+int UIReplayGame(GameState* game, GameRecord* record, const char* path, unsigned long long number);
+void UIReportTablebase(const GameState* game);
+int UILoadNetwork(const char* filename);
+void UIReportBook(const GameState* game);
+int UILoadBook(const char* filename);
+
+#endif // UI_H
@@ -0,0 +1,61 @@
+#include <pthread.h>
+#include "zobrist.h"
+#include "board.h"
+#include "bitops.h"
+
+unsigned long long ZOBRIST_KEYS[4][64];
+unsigned long long ZOBRIST_BLACK_TO_MOVE;
+
+// Concurrent first users (e.g. worker threads setting up positions) fill the tables once
+static pthread_once_t zobrist_once = PTHREAD_ONCE_INIT;
+
+// SplitMix64: small, fast generator with well-mixed output
+static unsigned long long NextRandom(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Fills the key tables from a fixed seed so hashes are stable between runs
+static void FillKeys(void) {
+    unsigned long long state = 0x436865636B657273ULL;  // "Checkers"
+    for (int kind = 0; kind < 4; kind++) {
+        for (int pos = 0; pos < 64; pos++) {
+            ZOBRIST_KEYS[kind][pos] = NextRandom(&state);
+        }
+    }
+    ZOBRIST_BLACK_TO_MOVE = NextRandom(&state);
+}
+
+// Makes sure the key tables are filled (safe to call from any thread)
+void InitZobrist(void) {
+    pthread_once(&zobrist_once, FillKeys);
+}
+
+// XORs the keys of every piece on one bitboard
+static unsigned long long HashBitboard(unsigned long long bb, int kind) {
+    unsigned long long hash = 0ULL;
+    int pos;
+    FOR_EACH_BIT(pos, bb) {
+        hash ^= ZOBRIST_KEYS[kind][pos];
+    }
+    return hash;
+}
+
+/**
+ * Computes a position's Zobrist key from scratch
+ * Only needed when a position is set up; moves update the key incrementally.
+ * @param game Pointer to game state
+ * @return 64-bit key of the pieces and side to move
+ */
+unsigned long long ComputeHash(const GameState* game) {
+    InitZobrist();
+
+    unsigned long long hash = HashBitboard(game->red_pieces, ZOBRIST_RED_MAN) ^
+                              HashBitboard(game->red_kings, ZOBRIST_RED_KING) ^
+                              HashBitboard(game->black_pieces, ZOBRIST_BLACK_MAN) ^
+                              HashBitboard(game->black_kings, ZOBRIST_BLACK_KING);
+    if (game->current_player == 1) hash ^= ZOBRIST_BLACK_TO_MOVE;
+    return hash;
+}
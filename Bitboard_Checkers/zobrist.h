@@ -0,0 +1,20 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "board.h"
+
+// Piece kinds indexing the Zobrist key table
+#define ZOBRIST_RED_MAN    0
+#define ZOBRIST_RED_KING   1
+#define ZOBRIST_BLACK_MAN  2
+#define ZOBRIST_BLACK_KING 3
+
+// Random keys per piece kind and square, plus one for Black to move
+extern unsigned long long ZOBRIST_KEYS[4][64];
+extern unsigned long long ZOBRIST_BLACK_TO_MOVE;
+
+// Zobrist functions
+void InitZobrist(void);
+unsigned long long ComputeHash(const GameState* game);
+
+#endif // ZOBRIST_H